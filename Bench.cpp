@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "Message.hpp"
+
+using namespace std;
+
+//
+// Scalability sweep of the protocol
+//
+// Usage: ./bench [hunters=2,4,8,16] [customers=1,2] [shopSize=1,4] [orders=2:5]
+//                [storeWait=1:10] [missionWait=1:10] [csv=bench.csv] [json=bench.json]
+//                [baseline=<csv>] [tolerance=0.2] [key=value ...]
+//
+// Runs `main` once for every combination of the swept values - the numbers
+// of Hunters and Customers, `shopSize`, `minOrders:maxOrders` and the store
+// and mission wait ranges - passing the other arguments on (by default
+// `transport=local virtualTime=1 timeUnit=us totalOrders=100`; with
+// `transport=mpi` every run is started with `mpirun`). For every point it
+// reports the orders completed per second of the run (of virtual time in a
+// simulation), the messages sent per order, in total and by tag, and the
+// quantiles of the order latency, to the CSV and JSON files.
+//
+// With a baseline (the CSV of an earlier sweep) every point is compared
+// with the same point of the baseline and the sweep exits with 2 if one
+// completes fewer orders per second or sends more messages per order than
+// `tolerance` allows, or if its latency quantiles grow by more than a bucket
+// (they are the bounds of power-of-two buckets). A failed run exits with 2
+// as well.
+//
+
+// Exit code if a point fails or regresses
+static const int RegressionExit = 2;
+
+// Arguments of `main` unless given
+static const vector<pair<string, string>> RunDefaults = {
+    { "transport", "local" },
+    { "virtualTime", "1" },
+    { "timeUnit", "us" },
+    { "totalOrders", "100" },
+};
+
+// Configuration of a point of the sweep
+struct Point {
+    uint64_t hunters;
+    uint64_t customers;
+    uint64_t shopSize;
+    uint64_t minOrders, maxOrders;
+    uint64_t storeWaitMin, storeWaitMax;
+    uint64_t missionWaitMin, missionWaitMax;
+};
+
+// Results of a point
+struct Result {
+    uint64_t orders = 0;
+    uint64_t elapsed = 0;
+    uint64_t sent[Tag::Count] = {};
+    uint64_t p50 = 0, p99 = 0, p999 = 0;
+
+    double ordersPerSecond() const {
+        return elapsed ? orders * 1e6 / elapsed : 0;
+    }
+
+    double messagesPerOrder(uint64_t messages) const {
+        return orders ? double(messages) / orders : 0;
+    }
+
+    uint64_t messages() const {
+        uint64_t total = 0;
+        for(uint64_t count: sent) total += count;
+        return total;
+    }
+};
+
+// Split the text at the separator
+static vector<string> split(const string& text, char separator) {
+    vector<string> parts;
+    stringstream stream(text);
+    string part;
+    while(getline(stream, part, separator)) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+// Parse a list of values, or of ranges `min:max` (a single value is a range of one)
+static bool parseList(const string& text, vector<pair<uint64_t, uint64_t>>& values) {
+    values.clear();
+    for(const string& item: split(text, ',')) {
+        vector<string> bounds = split(item, ':');
+        try {
+            uint64_t low = stoull(bounds.at(0));
+            uint64_t high = bounds.size() > 1 ? stoull(bounds.at(1)) : low;
+            values.emplace_back(low, high);
+        } catch(...) {
+            cerr << "Invalid value " << item << "\n";
+            return false;
+        }
+    }
+    return !values.empty();
+}
+
+// Read the number following the key in the metrics, starting at the position
+static bool readNumber(const string& metrics, const string& key, size_t& position, uint64_t& value) {
+    position = metrics.find("\"" + key + "\": ", position);
+    if(position == string::npos) return false;
+    position += key.size() + 4;
+    value = strtoull(metrics.c_str() + position, nullptr, 10);
+    return true;
+}
+
+// Read the results of a run from its metrics (see `Metrics::print`)
+static bool readResult(const string& fileName, Result& result) {
+    ifstream file(fileName);
+    stringstream text;
+    text << file.rdbuf();
+    string metrics = text.str();
+
+    size_t position = 0;
+    if(!readNumber(metrics, "elapsed_us", position, result.elapsed)) return false;
+    for(int i = 0; i < Tag::Count; i++) {
+        size_t tagPosition = position;
+        uint64_t unused;
+        if(!readNumber(metrics, Tag::name(Tag::First + i), tagPosition, unused)) return false;
+        if(!readNumber(metrics, "sent", tagPosition, result.sent[i])) return false;
+    }
+    position = metrics.find("\"orderLatency\": ", position);
+    return
+        position != string::npos &&
+        readNumber(metrics, "count", position, result.orders) &&
+        readNumber(metrics, "p50_us", position, result.p50) &&
+        readNumber(metrics, "p99_us", position, result.p99) &&
+        readNumber(metrics, "p999_us", position, result.p999);
+}
+
+// Columns identifying a point in the CSV report
+static const vector<string> KeyColumns = {
+    "hunters", "customers", "shopSize", "minOrders", "maxOrders",
+    "storeWaitMin", "storeWaitMax", "missionWaitMin", "missionWaitMax", "args"
+};
+
+// Values of the key columns of the point
+static vector<string> keyValues(const Point& point, const string& args) {
+    return {
+        to_string(point.hunters), to_string(point.customers), to_string(point.shopSize),
+        to_string(point.minOrders), to_string(point.maxOrders),
+        to_string(point.storeWaitMin), to_string(point.storeWaitMax),
+        to_string(point.missionWaitMin), to_string(point.missionWaitMax), args
+    };
+}
+
+// Read the rows of a CSV report by their key columns (false if there is no file)
+static bool readBaseline(const string& fileName, map<vector<string>, map<string, double>>& rows) {
+    ifstream file(fileName);
+    if(!file) return false;
+
+    string line;
+    if(!getline(file, line)) return true;
+    vector<string> header = split(line, ',');
+
+    while(getline(file, line)) {
+        vector<string> cells = split(line, ',');
+        map<string, string> row;
+        for(size_t i = 0; i < header.size() && i < cells.size(); i++) {
+            row[header[i]] = cells[i];
+        }
+
+        vector<string> key;
+        for(const string& column: KeyColumns) {
+            key.push_back(row[column]);
+        }
+        map<string, double>& values = rows[key];
+        for(const auto& [column, cell]: row) {
+            values[column] = strtod(cell.c_str(), nullptr);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    vector<pair<uint64_t, uint64_t>> hunters, customers, shopSizes, orders, storeWaits, missionWaits;
+    parseList("2,4,8,16", hunters);
+    parseList("1,2", customers);
+    parseList("1,4", shopSizes);
+    parseList("2:5", orders);
+    parseList("1:10", storeWaits);
+    parseList("1:10", missionWaits);
+    string csvFile = "bench.csv", jsonFile = "bench.json", baselineFile, program = "./main";
+    string launcher = "mpirun --oversubscribe";
+    double tolerance = 0.2;
+
+    // The arguments passed on to `main`
+    vector<pair<string, string>> runArgs = RunDefaults;
+
+    for(int i = 1; i < argc; i++) {
+        string arg(argv[i]);
+        size_t delimiter = arg.find('=');
+        if(delimiter == string::npos) continue;
+        string key = arg.substr(0, delimiter);
+        string value = arg.substr(delimiter + 1);
+
+        bool valid = true;
+        if(key == "hunters") {
+            valid = parseList(value, hunters);
+        } else if(key == "customers") {
+            valid = parseList(value, customers);
+        } else if(key == "shopSize") {
+            valid = parseList(value, shopSizes);
+        } else if(key == "orders") {
+            valid = parseList(value, orders);
+        } else if(key == "storeWait") {
+            valid = parseList(value, storeWaits);
+        } else if(key == "missionWait") {
+            valid = parseList(value, missionWaits);
+        } else if(key == "csv") {
+            csvFile = value;
+        } else if(key == "json") {
+            jsonFile = value;
+        } else if(key == "baseline") {
+            baselineFile = value;
+        } else if(key == "tolerance") {
+            tolerance = strtod(value.c_str(), nullptr);
+        } else if(key == "main") {
+            program = value;
+        } else if(key == "mpirun") {
+            launcher = value;
+        } else {
+            auto given = find_if(runArgs.begin(), runArgs.end(), [&key](const auto& a) { return a.first == key; });
+            if(given != runArgs.end()) {
+                given->second = value;
+            } else {
+                runArgs.emplace_back(key, value);
+            }
+        }
+        if(!valid) return 1;
+    }
+
+    bool mpi = find(runArgs.begin(), runArgs.end(), make_pair(string("transport"), string("mpi"))) != runArgs.end();
+    string args;
+    for(const auto& [key, value]: runArgs) {
+        args += (args.empty() ? "" : " ") + key + "=" + value;
+    }
+
+    map<vector<string>, map<string, double>> baseline;
+    bool compare = !baselineFile.empty() && readBaseline(baselineFile, baseline);
+    if(!baselineFile.empty() && !compare) {
+        cerr << "No baseline " << baselineFile << ", not comparing\n";
+    }
+
+    vector<Point> points;
+    for(const auto& hunterCount: hunters)
+    for(const auto& customerCount: customers)
+    for(const auto& shopSize: shopSizes)
+    for(const auto& [minOrders, maxOrders]: orders)
+    for(const auto& [storeWaitMin, storeWaitMax]: storeWaits)
+    for(const auto& [missionWaitMin, missionWaitMax]: missionWaits) {
+        points.push_back({
+            hunterCount.first, customerCount.first, shopSize.first, minOrders, maxOrders,
+            storeWaitMin, storeWaitMax, missionWaitMin, missionWaitMax });
+    }
+
+    char metricsFile[] = "/tmp/bench-XXXXXX";
+    int descriptor = mkstemp(metricsFile);
+    if(descriptor < 0) {
+        cerr << "Cannot create a metrics file\n";
+        return 1;
+    }
+    close(descriptor);
+
+    ofstream csv(csvFile);
+    csv << fixed;
+    for(const string& column: KeyColumns) {
+        csv << column << ",";
+    }
+    csv << "orders,elapsed_us,orders_per_sec,messages_per_order";
+    for(int i = 0; i < Tag::Count; i++) {
+        csv << "," << Tag::name(Tag::First + i) << "_per_order";
+    }
+    csv << ",p50_us,p99_us,p999_us\n";
+
+    ofstream json(jsonFile);
+    json << fixed;
+    json << "[\n";
+    bool firstJson = true;
+
+    cout << " hunters customers shop  orders  store  mission   orders/s  msgs/order      p50      p99     p999\n";
+    uint64_t failures = 0, regressions = 0;
+
+    for(const Point& point: points) {
+        ostringstream command;
+        if(mpi) {
+            command << launcher << " -np " << point.customers + point.hunters << " ";
+        }
+        command << program << " " << args
+            << " hunterMin=" << point.customers
+            << " hunterMax=" << point.customers + point.hunters - 1
+            << " shopSize=" << point.shopSize
+            << " minOrders=" << point.minOrders << " maxOrders=" << point.maxOrders
+            << " storeWaitMin=" << point.storeWaitMin << " storeWaitMax=" << point.storeWaitMax
+            << " missionWaitMin=" << point.missionWaitMin << " missionWaitMax=" << point.missionWaitMax
+            << " metricsFile=" << metricsFile << " > /dev/null";
+
+        remove(metricsFile);
+        Result result;
+        if(system(command.str().c_str()) != 0 || !readResult(metricsFile, result)) {
+            cerr << "Failed: " << command.str() << "\n";
+            failures += 1;
+            continue;
+        }
+
+        cout << setw(8) << point.hunters << setw(10) << point.customers << setw(5) << point.shopSize
+            << setw(8) << (to_string(point.minOrders) + ":" + to_string(point.maxOrders))
+            << setw(7) << (to_string(point.storeWaitMin) + ":" + to_string(point.storeWaitMax))
+            << setw(9) << (to_string(point.missionWaitMin) + ":" + to_string(point.missionWaitMax))
+            << fixed << setprecision(0) << setw(11) << result.ordersPerSecond()
+            << setprecision(2) << setw(12) << result.messagesPerOrder(result.messages())
+            << setw(9) << result.p50 << setw(9) << result.p99 << setw(9) << result.p999 << "\n";
+
+        vector<string> key = keyValues(point, args);
+        for(const string& value: key) {
+            csv << value << ",";
+        }
+        csv << result.orders << "," << result.elapsed << ","
+            << setprecision(1) << result.ordersPerSecond() << ","
+            << setprecision(3) << result.messagesPerOrder(result.messages());
+        for(int i = 0; i < Tag::Count; i++) {
+            csv << "," << result.messagesPerOrder(result.sent[i]);
+        }
+        csv << "," << result.p50 << "," << result.p99 << "," << result.p999 << "\n";
+
+        json << (firstJson ? "" : ",\n") << "  { ";
+        firstJson = false;
+        for(size_t i = 0; i + 1 < KeyColumns.size(); i++) {
+            json << "\"" << KeyColumns[i] << "\": " << key[i] << ", ";
+        }
+        json << "\"args\": \"" << args << "\",\n"
+            << "    \"orders\": " << result.orders << ", \"elapsed_us\": " << result.elapsed
+            << ", \"orders_per_sec\": " << setprecision(1) << result.ordersPerSecond()
+            << ", \"messages_per_order\": " << setprecision(3) << result.messagesPerOrder(result.messages())
+            << ",\n    \"messages_per_order_by_tag\": {";
+        for(int i = 0; i < Tag::Count; i++) {
+            json << (i ? ", " : " ") << "\"" << Tag::name(Tag::First + i) << "\": "
+                << result.messagesPerOrder(result.sent[i]);
+        }
+        json << " },\n    \"latency_us\": { \"p50\": " << result.p50 << ", \"p99\": " << result.p99
+            << ", \"p999\": " << result.p999 << " } }";
+
+        if(!compare) continue;
+        auto before = baseline.find(key);
+        if(before == baseline.end()) {
+            cerr << "  not in the baseline\n";
+            continue;
+        }
+        map<string, double>& old = before->second;
+        auto regression = [&regressions](const string& what, double was, double is) {
+            regressions += 1;
+            cerr << "  Regression: " << what << " " << was << " -> " << is << "\n";
+        };
+        if(result.ordersPerSecond() < old["orders_per_sec"] * (1 - tolerance)) {
+            regression("orders/s", old["orders_per_sec"], result.ordersPerSecond());
+        }
+        if(result.messagesPerOrder(result.messages()) > old["messages_per_order"] * (1 + tolerance)) {
+            regression("messages/order", old["messages_per_order"], result.messagesPerOrder(result.messages()));
+        }
+        if(result.p50 > 2 * old["p50_us"]) {
+            regression("p50 latency", old["p50_us"], result.p50);
+        }
+        if(result.p99 > 2 * old["p99_us"]) {
+            regression("p99 latency", old["p99_us"], result.p99);
+        }
+    }
+    json << "\n]\n";
+    remove(metricsFile);
+
+    cout << "Points: " << points.size() << ", failed: " << failures;
+    if(compare) {
+        cout << ", regressions: " << regressions;
+    }
+    cout << "\n";
+
+    return failures == 0 && regressions == 0 ? 0 : RegressionExit;
+}
@@ -0,0 +1,71 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace std;
+
+// Time source of a single process (in microseconds).
+//
+// In the real mode the clock follows the steady clock and `wait` sleeps.
+// In the virtual mode `wait` only advances the clock, and every received
+// message moves it forward to the sender's time - so a process continues
+// as soon as the protocol allows, without spending any wall-clock time.
+class Clock {
+private:
+
+    // Use the virtual time
+    const bool virtualTime;
+
+    // Start of the real time
+    const chrono::steady_clock::time_point start;
+
+    // Current virtual time
+    atomic<uint64_t> virtualNow { 0 };
+
+public:
+
+    Clock(bool virtualTime) :
+        virtualTime(virtualTime),
+        start(chrono::steady_clock::now())
+        { }
+
+    // Return the current time
+    uint64_t now() const {
+        if(virtualTime) {
+            return virtualNow.load();
+        }
+        return chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - start).count();
+    }
+
+    // Start of the clock on a time scale shared by the processes of a machine
+    // (the epoch of the steady clock; 0 for the virtual time, which is shared anyway)
+    uint64_t origin() const {
+        if(virtualTime) {
+            return 0;
+        }
+        return chrono::duration_cast<chrono::microseconds>(start.time_since_epoch()).count();
+    }
+
+    // Let the given amount of time pass
+    void wait(uint64_t duration) {
+        if(virtualTime) {
+            virtualNow.fetch_add(duration);
+        } else {
+            this_thread::sleep_for(chrono::microseconds(duration));
+        }
+    }
+
+    // Move the virtual time to the time of a received message
+    void merge(uint64_t received) {
+        if(!virtualTime) return;
+        uint64_t current = virtualNow.load();
+        while(current < received && !virtualNow.compare_exchange_weak(current, received)) { }
+    }
+};
+
+#endif
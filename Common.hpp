@@ -6,73 +6,160 @@
 #include <iomanip>
 #include <fstream>
 
+#include "Log.hpp"
 #include "Message.hpp"
 
 using namespace std;
 
+enum class HunterState {
+    Waiting,
+    GettingOrder,
+    GettingStore,
+    InStore,
+    Mission
+};
+
+// Number of the Hunter states
+const int HunterStateCount = 5;
+
+inline const char* name(HunterState state) {
+    switch(state) {
+    case HunterState::Waiting:      return "Waiting";
+    case HunterState::GettingOrder: return "GettingOrder";
+    case HunterState::GettingStore: return "GettingStore";
+    case HunterState::InStore:      return "InStore";
+    case HunterState::Mission:      return "Mission";
+    }
+    return "Unknown";
+}
+
 class Loggable {
 public:
     virtual uint64_t getLamport() = 0;
 };
 
-class Logger {
+// A line being logged - written to the log at the end of the expression,
+// or of the scope of a line kept to be built over several statements.
+// Lines of disabled levels compile to nothing.
+template<bool Enabled>
+class LogLine {
+public:
+    template<typename T>
+    const LogLine& operator<< (const T&) const {
+        return *this;
+    }
+};
+
+template<>
+class LogLine<true> {
 private:
-    int64_t id;
-    string type;
-    ostream& stream;
-    Loggable* object;
+    LogSink* sink;
+    mutable LogRecord record;
 
 public:
 
-    Logger(Loggable* object, int64_t id, const string& type, ostream& stream = cout) :
-        id(id), type(type), stream(stream), object(object) { }
+    LogLine(LogSink* sink, uint32_t source, uint64_t lamport) : sink(sink) {
+        record.source = source;
+        record.lamport = lamport;
+    }
+
+    LogLine(LogLine&& other) : sink(other.sink), record(other.record) {
+        other.sink = nullptr;
+    }
+
+    ~LogLine() {
+        if(sink) sink->push(record);
+    }
+
+    // Strings have to be static (string literals)
+    const LogLine& operator<< (const char* text) const {
+        record.add(LogItem::Text, { reinterpret_cast<uint64_t>(text) });
+        return *this;
+    }
 
-    const Logger& operator()() const {
-        stream
-            << type
-            << " [" << setfill('0') << setw(2) << id << "] "
-            << setfill('0') << setw(5) << object->getLamport() << ": ";
+    template<typename T, typename = enable_if_t<is_integral_v<T>>>
+    const LogLine& operator<< (T value) const {
+        if(is_signed_v<T>) {
+            record.add(LogItem::Signed, { static_cast<uint64_t>(static_cast<int64_t>(value)) });
+        } else {
+            record.add(LogItem::Unsigned, { static_cast<uint64_t>(value) });
+        }
+        return *this;
+    }
 
+    const LogLine& operator<< (const Order& order) const {
+        record.add(LogItem::Order, { static_cast<uint64_t>(order.customer), order.lamport });
         return *this;
     }
 
-    const Logger& operator<< (const Order& order) const {
-        stream << "Order(customer = " << order.customer <<
-            ", orderLamport = " << order.lamport << ")";
+    const LogLine& operator<< (const OrderCompletion& completion) const {
+        record.add(LogItem::OrderCompletion, { static_cast<uint64_t>(completion.customer), completion.orderLamport });
         return *this;
     }
 
-    const Logger& operator<< (const OrderCompletion& completion) const {
-        stream << "OrderCompletion(customer = " << completion.customer <<
-            ", orderLamport = " << completion.orderLamport << ")";
+    const LogLine& operator<< (const OrderRequest& request) const {
+        record.add(LogItem::OrderRequest, {
+            static_cast<uint64_t>(request.orderCustomers[0]), request.orderLamports[0], request.count,
+            request.lastOrderLamport });
         return *this;
     }
 
-    const Logger& operator<< (const OrderRequest& request) const {
-        stream << "OrderRequest(customer = "
-            << request.orderCustomer << ", orderLamport = " << request.orderLamport
-            << ", lastOrder = " << request.lastOrderLamport << ")";
+    const LogLine& operator<< (const OrderRequestAck& ack) const {
+        record.add(LogItem::OrderRequestAck, { static_cast<uint64_t>(ack.orderCustomer), ack.orderLamport });
         return *this;
     }
 
-    const Logger& operator<< (const OrderRequestAck& ack) const {
-        stream << "OrderRequestAck(customer = "
-            << ack.orderCustomer << ", orderLamport = "
-            << ack.orderLamport << ")";
+    const LogLine& operator<< (const Token& token) const {
+        record.add(LogItem::Token, { static_cast<uint64_t>(token.count), token.black });
         return *this;
     }
 
-    const Logger& operator<< (const StoreRequestAck& ack) const {
-        stream << "StoreRequestAck(requestLamport = "
-            << ack.requestLamport << ")";
+    const LogLine& operator<< (const StoreRequest& request) const {
+        record.add(LogItem::StoreRequest, { request.lamport });
         return *this;
     }
 
-    template <typename T>
-    const Logger& operator<< (const T& data) const {
-        stream << data;
+    const LogLine& operator<< (const StoreRequestAck& ack) const {
+        record.add(LogItem::StoreRequestAck, { ack.requestLamport });
         return *this;
     }
+};
+
+class Logger {
+private:
+    Loggable* object;
+    LogSink* sink;
+    uint32_t source = 0;
+
+    template<int Level>
+    LogLine<Level >= LOG_LEVEL> line() const {
+        if constexpr(Level >= LOG_LEVEL) {
+            return { sink, source, object->getLamport() };
+        } else {
+            return {};
+        }
+    }
+
+public:
+
+    // Log to the sink of the process (none with logging compiled out)
+    Logger(Loggable* object, LogSink* sink, int64_t id, const string& type) :
+        object(object), sink(sink)
+    {
+        if(sink) {
+            source = sink->attach(id, type);
+        }
+    }
+
+    // Start an info line
+    LogLine<LOG_LEVEL_INFO >= LOG_LEVEL> operator()() const {
+        return line<LOG_LEVEL_INFO>();
+    }
+
+    // Start a debug line (messaging details)
+    LogLine<LOG_LEVEL_DEBUG >= LOG_LEVEL> debug() const {
+        return line<LOG_LEVEL_DEBUG>();
+    }
 
 };
 
@@ -3,9 +3,62 @@
 
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <cstdint>
 
 using namespace std;
 
+// Algorithm admitting the Hunters to the store
+enum class StoreAdmission {
+	// Ask all the other Hunters for a permission (Ricart-Agrawala)
+	Requests,
+	// Circulate `shopSize` tokens between the Hunters
+	Token,
+	// Ask a grid quorum of Hunters (Maekawa)
+	Quorum,
+	// Take a ticket of a semaphore in shared memory (one-sided atomics)
+	Shared
+};
+
+// Algorithm deciding which Hunter serves an order
+enum class OrderAssignment {
+	// All the idle Hunters contest for the first pending order
+	Contest,
+	// The order is owned by a Hunter chosen by rendezvous hashing, idle Hunters steal
+	Owner,
+	// The Customers append the orders to a global ring, the Hunters claim them (one-sided atomics)
+	Queue
+};
+
+// Which pending orders an idle Hunter contests (the contest assignment)
+enum class OrderSelection {
+	// The oldest pending order - every Hunter goes after the same one
+	Front,
+	// The one at an offset of the rank of the Hunter, among the first `selectionWidth`
+	Stride,
+	// A random one among the first `selectionWidth`
+	Random,
+	// The older or the newer of two random ones among the first `selectionWidth`,
+	// by the priority of the Hunter (power of two choices)
+	Choices
+};
+
+// How a Customer decides the number of its uncompleted orders
+enum class FlowControl {
+	// Between the fixed bounds `minOrders` and `maxOrders`
+	Static,
+	// A window sized from the order latencies (AIMD), up to `maxOrders`
+	Adaptive
+};
+
+// Transport of the messages between the agents
+enum class TransportKind {
+	// Every agent is an MPI process
+	Mpi,
+	// Every agent is a thread of a single process, with a lock-free mailbox
+	Local
+};
+
 struct Config {
 
 	// The size of the shop
@@ -17,32 +70,176 @@ struct Config {
 	// The upper bound of pending orders (HM)
 	uint8_t maxOrders = 5;
 
+	// The most orders placed in one message (up to OrderBatch::MaxOrders)
+	uint8_t orderBatch = 4;
+
+	// The most orders a Hunter serves in one store visit and mission (up to OrderRequest::MaxOrders)
+	uint8_t missionOrders = 1;
+
+	// Ask for the store along with the orders, in one round (the contest with the requests admission)
+	bool combinedRequests = false;
+
+	// Keep the store permissions until the other Hunters ask for the store (the requests admission)
+	bool keepPermissions = false;
+
+	// How a Customer decides the number of its uncompleted orders: static or adaptive
+	FlowControl flowControl = FlowControl::Static;
+
+	// Order latency the adaptive flow control aims for (in time units, 0 - derived from the latencies)
+	uint64_t latencyTarget = 0;
+
+	// Algorithm admitting the Hunters to the store: requests, token, quorum or shared
+	StoreAdmission storeAdmission = StoreAdmission::Requests;
+
+	// Algorithm deciding which Hunter serves an order: contest, owner or queue
+	OrderAssignment orderAssignment = OrderAssignment::Contest;
+
+	// Which pending orders an idle Hunter contests: front, stride, random or choices
+	OrderSelection orderSelection = OrderSelection::Front;
+
+	// Number of the oldest pending orders (groups of `missionOrders`) a selection chooses from
+	uint8_t selectionWidth = 4;
+
+	// Transport of the messages: mpi or local (all the agents in one process)
+	TransportKind transport = TransportKind::Mpi;
+
 	// The lowest identifier of a Hunter
     int64_t hunterMin = 1;
 
 	// The highest identifier of a Hunter
     int64_t hunterMax = 2;
 
-	// The minimal time a Hunter will wait in the store (in seconds)
-    uint8_t storeWaitMin = 1;
+	// The minimal time a Hunter will wait in the store (in time units)
+    uint32_t storeWaitMin = 1;
+
+	// The maximal time a Hunter will wait in the store (in time units)
+    uint32_t storeWaitMax = 10;
+
+	// The minimal time a Hunter will spend on a mission (in time units)
+    uint32_t missionWaitMin = 1;
+
+	// The maximal time a Hunter will spend on a mission (in time units)
+    uint32_t missionWaitMax = 10;
 
-	// The maximal time a Hunter will wait in the store (in seconds)
-    uint8_t storeWaitMax = 10;
+	// The length of a single time unit (in microseconds): s, ms or us
+	uint64_t timeUnit = 1000000;
 
-	// The minimal time a Hunter will spend on a mission (in seconds)
-    uint8_t missionWaitMin = 1;
+	// Advance a virtual clock instead of sleeping (discrete-event simulation)
+	bool virtualTime = false;
 
-	// The maximal time a Hunter will spend on a mission (in seconds)
-    uint8_t missionWaitMax = 10;
+	// The number of orders placed by each Customer (0 - unlimited)
+	uint64_t totalOrders = 0;
+
+	// The time after which the Customers stop placing orders (in time units, 0 - unlimited)
+	uint64_t duration = 0;
+
+	// Ranks per node, to group the processes into nodes by rank (0 - the shared-memory nodes)
+	int64_t nodeSize = 0;
+
+	// File the metrics are written to as JSON (standard output if empty)
+	string metricsFile;
+
+	// Prefix of the binary log files (`<logFile>.<rank>`, text to the standard output if empty)
+	string logFile;
+
+	// Prefix of the trace files of the agents (`<traceFile>.<id>`, no tracing if empty)
+	string traceFile;
+
+	// Prefix of the event logs of the agents for the verifier (`<eventFile>.<id>`, none if empty)
+	string eventFile;
+
+	// Prefix of the files the delivery order of the agents is recorded to (`<recordFile>.<id>`, none if empty)
+	string recordFile;
+
+	// Prefix of the recorded delivery orders to replay (`<replayFile>.<id>`, none if empty)
+	string replayFile;
+
+	// Seed of the random durations of the Hunters
+	uint64_t seed = 0;
 
 	// Set a value by field name
 	void set(string_view key, string_view value) {
 
-		// Convert string_view to uint8_t
+		// Non-numeric values
+		if(key == "timeUnit") {
+			if(value == "s") {
+				timeUnit = 1000000;
+			} else if(value == "ms") {
+				timeUnit = 1000;
+			} else if(value == "us") {
+				timeUnit = 1;
+			}
+			return;
+		} else if(key == "storeAdmission") {
+			if(value == "requests") {
+				storeAdmission = StoreAdmission::Requests;
+			} else if(value == "token") {
+				storeAdmission = StoreAdmission::Token;
+			} else if(value == "quorum") {
+				storeAdmission = StoreAdmission::Quorum;
+			} else if(value == "shared") {
+				storeAdmission = StoreAdmission::Shared;
+			}
+			return;
+		} else if(key == "orderAssignment") {
+			if(value == "contest") {
+				orderAssignment = OrderAssignment::Contest;
+			} else if(value == "owner") {
+				orderAssignment = OrderAssignment::Owner;
+			} else if(value == "queue") {
+				orderAssignment = OrderAssignment::Queue;
+			}
+			return;
+		} else if(key == "flowControl") {
+			if(value == "static") {
+				flowControl = FlowControl::Static;
+			} else if(value == "adaptive") {
+				flowControl = FlowControl::Adaptive;
+			}
+			return;
+		} else if(key == "orderSelection") {
+			if(value == "front") {
+				orderSelection = OrderSelection::Front;
+			} else if(value == "stride") {
+				orderSelection = OrderSelection::Stride;
+			} else if(value == "random") {
+				orderSelection = OrderSelection::Random;
+			} else if(value == "choices") {
+				orderSelection = OrderSelection::Choices;
+			}
+			return;
+		} else if(key == "transport") {
+			if(value == "mpi") {
+				transport = TransportKind::Mpi;
+			} else if(value == "local") {
+				transport = TransportKind::Local;
+			}
+			return;
+		} else if(key == "metricsFile") {
+			metricsFile = value;
+			return;
+		} else if(key == "logFile") {
+			logFile = value;
+			return;
+		} else if(key == "traceFile") {
+			traceFile = value;
+			return;
+		} else if(key == "eventFile") {
+			eventFile = value;
+			return;
+		} else if(key == "recordFile") {
+			recordFile = value;
+			return;
+		} else if(key == "replayFile") {
+			replayFile = value;
+			return;
+		}
+
+		// Convert string_view to an integer
 		int64_t intValue;
 		try {
 			string stringValue(value);
-			intValue = stoi(stringValue);
+			intValue = stoll(stringValue);
 		} catch (...) {
 			return;
 		}
@@ -53,6 +250,12 @@ struct Config {
 			minOrders = intValue;
 		} else if(key == "maxOrders") {
 			maxOrders = intValue;
+		} else if(key == "orderBatch") {
+			orderBatch = intValue;
+		} else if(key == "missionOrders") {
+			missionOrders = intValue;
+		} else if(key == "latencyTarget") {
+			latencyTarget = intValue;
 		} else if(key == "hunterMin") {
 			hunterMin = intValue;
 		} else if(key == "hunterMax") {
@@ -65,6 +268,22 @@ struct Config {
 			missionWaitMin = intValue;
 		} else if(key == "missionWaitMax") {
 			missionWaitMax = intValue;
+		} else if(key == "totalOrders") {
+			totalOrders = intValue;
+		} else if(key == "duration") {
+			duration = intValue;
+		} else if(key == "nodeSize") {
+			nodeSize = intValue;
+		} else if(key == "virtualTime") {
+			virtualTime = intValue != 0;
+		} else if(key == "combinedRequests") {
+			combinedRequests = intValue != 0;
+		} else if(key == "selectionWidth") {
+			selectionWidth = intValue;
+		} else if(key == "keepPermissions") {
+			keepPermissions = intValue != 0;
+		} else if(key == "seed") {
+			seed = intValue;
 		}
 	}
 
@@ -1,69 +1,168 @@
 #include "Customer.hpp"
 
-Customer::Customer(int64_t id, const Config& config) :
+#include <algorithm>
+
+Customer::Customer(int64_t id, const Config& config, Transport& transport, LogSink* logSink, const Topology& topology, Metrics& metrics) :
     id(id),
     config(config),
-    types(),
-    logger(this, id, "C ")
-    { };
+    orderRing(config.orderAssignment == OrderAssignment::Queue ? make_unique<OrderRing>(config, topology) : nullptr),
+    messenger(transport.connect(id)),
+    logger(this, logSink, id, "C "),
+    clock(config.virtualTime),
+    metrics(metrics),
+    window(config)
+    {
+        if(!config.traceFile.empty()) {
+            tracer = make_unique<Tracer>(id, "Customer", config, clock);
+            messenger->setTracer(tracer.get());
+        }
+        if(!config.eventFile.empty()) {
+            events = make_unique<EventLog>(id, config.eventFile, config.shopSize, clock);
+        }
+        if(!config.recordFile.empty() || !config.replayFile.empty()) {
+            deliveries = make_unique<DeliveryLog>(id, config);
+            messenger->setDeliveryLog(deliveries.get());
+        }
+    };
 
 uint64_t Customer::getLamport() {
     return lamport;
 }
 
 void Customer::loop() {
-    while(true) {
-        while(orders.size() < config.maxOrders) {
-            placeOrder();
+    // New orders are placed as soon as there is room for them,
+    // while the completions of the previous ones come in
+    while(!finished() || !orders.empty()) {
+
+        // Handle all the completions which have arrived
+        while(messenger->poll(status)) {
+            handleOrderCompletion();
         }
-        logger() << "Reached the limit of not completed orders, waiting for completions\n";
-        while(orders.size() > config.minOrders) {
-            receiveOrderCompletion();
+
+        if(uint64_t count = ordersToPlace(); count != 0) {
+            placeOrders(count);
+        } else if(!orders.empty()) {
+            logger.debug() << "No room for new orders, waiting for completions\n";
+            uint64_t awaiting = clock.now();
+            messenger->receive(status);
+            handleOrderCompletion();
+            if(tracer) tracer->span(Tracer::States, "Awaiting", awaiting, clock.now());
         }
-        logger() << "Fell below the lower limit of not completed orders, placing new orders...\n";
     }
+
+    sendFinish();
+    metrics.finish(clock.now());
 }
 
-// Place a new order
-void Customer::placeOrder() {
+// Return the number of orders to place now (0 if none)
+uint64_t Customer::ordersToPlace() const {
+    if(finished()) return 0;
 
-    lamport += 1;
+    // The adaptive window takes the place of the fixed bounds, the lower one at half the window
+    bool adaptive = config.flowControl == FlowControl::Adaptive;
+    uint64_t upper = adaptive ? window.size() : config.maxOrders;
+    uint64_t lower = adaptive ? upper / 2 : config.minOrders;
 
-    // Create new order and place it on the list
-    auto& newOrder = orders.emplace_back(id, lamport);
+    uint64_t room = orders.size() < upper ? upper - orders.size() : 0;
+    if(config.totalOrders != 0) {
+        room = min(room, config.totalOrders - placedOrders);
+    }
+    uint64_t batch = clamp<uint64_t>(config.orderBatch, 1, OrderBatch::MaxOrders);
+
+    // A full batch, or whatever fits once the pending orders fall to the lower bound
+    if(room >= batch) return batch;
+    if(orders.size() <= lower) return room;
+    return 0;
+}
+
+// Check if no more orders should be placed
+bool Customer::finished() const {
+    return
+        (config.totalOrders != 0 && placedOrders >= config.totalOrders) ||
+        (config.duration != 0 && clock.now() >= config.duration * config.timeUnit);
+}
+
+// Tell the Hunters that no more orders will be placed
+void Customer::sendFinish() {
+    lamport += 1;
+    Finish finish { placedOrders, lamport, clock.now() };
 
-    logger() << "📤 Placing " << newOrder << "\n";
+    logger() << "🏁 All " << placedOrders << " orders completed, finishing\n";
 
-    // Send a new order to all the hunters
+    messenger->broadcast(finish, Tag::Finish);
     for(int i = config.hunterMin; i <= config.hunterMax; i++) {
-        MPI_Send(&newOrder, 1, types.order, i, Tag::Order, MPI_COMM_WORLD);
+        metrics.sent(Tag::Finish);
     }
+}
+
+// Place new orders in one message
+void Customer::placeOrders(uint64_t count) {
+    uint64_t placing = clock.now();
+    OrderBatch batch;
+    batch.customer = id;
+    batch.count = count;
+
+    // A batch starts a new group of the orders the Hunters contest for together (see `Hunter::sameGroup`)
+    uint64_t group = clamp<uint64_t>(config.missionOrders, 1, OrderRequest::MaxOrders);
+    lamport += (group - lamport % group) % group;
+
+    for(uint64_t i = 0; i < count; i++) {
+        lamport += 1;
+        placedOrders += 1;
 
+        batch.orderLamports[i] = lamport;
+        batch.orderTimes[i] = clock.now();
+        orders[lamport] = batch.orderTimes[i];
+
+        logger() << "📤 Placing " << batch.order(i) << "\n";
+        if(events) events->order(EventKind::OrderPlaced, batch.order(i), lamport);
+    }
+    batch.lamport = lamport;
+    batch.time = clock.now();
+
+    // Append the new orders to the global queue
+    if(orderRing) {
+        for(uint64_t i = 0; i < count; i++) {
+            orderRing->push(batch.order(i));
+        }
+        if(tracer) tracer->span(Tracer::States, "Placing", placing, clock.now());
+        return;
+    }
+
+    // Send the new orders to all the hunters
+    messenger->broadcast(batch, Tag::Order);
+    for(int i = config.hunterMin; i <= config.hunterMax; i++) {
+        metrics.sent(Tag::Order);
+    }
+    if(tracer) tracer->span(Tracer::States, "Placing", placing, clock.now());
 }
 
-// Receive order from a Hunter
-void Customer::receiveOrderCompletion() {
+// Handle a received order completion
+void Customer::handleOrderCompletion() {
     OrderCompletion completion;
-
-    MPI_Recv(
-        &completion,
-        1,
-        types.orderCompletion,
-        MPI_ANY_SOURCE,
-        Tag::OrderCompletion,
-        MPI_COMM_WORLD,
-        &status);
+    messenger->take(completion);
 
     // Increment the lamport clock
     lamport = max(lamport, completion.lamport) + 1;
+    clock.merge(completion.time);
+    metrics.received(Tag::OrderCompletion);
 
     logger() << "✅ Received " << completion << " from " << status.MPI_SOURCE << "\n";
+    if(events) events->order(EventKind::OrderCompleted, Order(id, completion.orderLamport), lamport);
 
-    // Remove the order from the list
-    orders.remove_if([&completion](const Order& order) {
-        return 
-            order.customer == completion.customer &&
-            order.lamport == completion.orderLamport;
-    });
+    // Remove the order
+    if(auto it = orders.find(completion.orderLamport); it != orders.end()) {
+        uint64_t latency = clock.now() - it->second;
+        metrics.orderCompleted(latency);
+        orders.erase(it);
 
+        if(config.flowControl == FlowControl::Adaptive) {
+            uint64_t before = window.size();
+            window.completed(completion.orderLamport, latency, lamport);
+            if(window.size() != before) {
+                logger.debug() << "Order window " << before << " -> " << window.size()
+                    << " (latency " << latency << ", target " << window.target() << ")\n";
+            }
+        }
+    }
 }
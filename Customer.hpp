@@ -1,12 +1,22 @@
 #ifndef CUSTOMER_HPP
 #define CUSTOMER_HPP
 
-#include <list>
+#include <memory>
+#include <unordered_map>
 #include <mpi.h>
 
+#include "Clock.hpp"
 #include "Config.hpp"
+#include "DeliveryLog.hpp"
+#include "EventLog.hpp"
 #include "Common.hpp"
 #include "Message.hpp"
+#include "Messenger.hpp"
+#include "Metrics.hpp"
+#include "OrderRing.hpp"
+#include "OrderWindow.hpp"
+#include "Topology.hpp"
+#include "Tracer.hpp"
 
 class Customer: Loggable {
 private:
@@ -17,32 +27,65 @@ private:
     // Configuration of the program
     const Config config;
 
-    // Datatypes used by the MPI
-    const Datatype types;
+    // Global queue of the orders (the queue assignment)
+    unique_ptr<OrderRing> orderRing;
+
+    // Sends and receives the messages
+    unique_ptr<Messenger> messenger;
 
     // Logger which prints Lamport values
     const Logger logger;
 
+    // Real or virtual time
+    Clock clock;
+
+    // Counters and histograms
+    Metrics& metrics;
+
+    // Timeline of the Customer (if traced)
+    unique_ptr<Tracer> tracer;
+
+    // Events for the verifier (if recorded)
+    unique_ptr<EventLog> events;
+
+    // Delivery order of the messages (if recorded or replayed)
+    unique_ptr<DeliveryLog> deliveries;
+
     // State
 
     // Lamport clock
     uint64_t lamport = 0;
 
-    // List of uncompleted orders
-    list<Order> orders;
+    // Uncompleted orders - time of placing by the Lamport value
+    unordered_map<uint64_t, uint64_t> orders;
 
-    // Status used by the MPI_Recv
+    // Number of placed orders
+    uint64_t placedOrders = 0;
+
+    // Number of uncompleted orders allowed (the adaptive flow control)
+    OrderWindow window;
+
+    // Status of the last received message
     MPI_Status status;
 
-    // Place a new order
-    void placeOrder();
+    // Return the number of orders to place now (0 if none)
+    uint64_t ordersToPlace() const;
+
+    // Place new orders in one message
+    void placeOrders(uint64_t count);
+
+    // Handle a received order completion
+    void handleOrderCompletion();
+
+    // Check if no more orders should be placed
+    bool finished() const;
 
-    // Receive order from a Hunter (blocks the thread)
-    void receiveOrderCompletion();
+    // Tell the Hunters that no more orders will be placed
+    void sendFinish();
 
 public:
 
-    Customer(int64_t id, const Config& config);
+    Customer(int64_t id, const Config& config, Transport& transport, LogSink* logSink, const Topology& topology, Metrics& metrics);
 
     // Return the current lamport value
     uint64_t getLamport() override;
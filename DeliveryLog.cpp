@@ -0,0 +1,54 @@
+#include "DeliveryLog.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+DeliveryLog::DeliveryLog(int64_t id, const Config& config) :
+    id(id),
+    replay(!config.replayFile.empty())
+    {
+        // A virtual-time run never stands still for long - a real-time one
+        // may wait out a store visit and a mission of every Hunter
+        patience = 1000000;
+        if(!config.virtualTime) {
+            uint64_t longest = (config.storeWaitMax + config.missionWaitMax) * config.timeUnit;
+            patience = max(patience, 2 * longest);
+        }
+
+        DeliveryFile::Header header;
+
+        if(!replay) {
+            file.open(config.recordFile + "." + to_string(id), ios::binary);
+            memcpy(header.magic, DeliveryFile::Magic, sizeof(header.magic));
+            header.seed = config.seed;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            return;
+        }
+
+        string fileName = config.replayFile + "." + to_string(id);
+        ifstream recorded(fileName, ios::binary);
+        if(
+            !recorded.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            memcmp(header.magic, DeliveryFile::Magic, sizeof(header.magic)) != 0) {
+
+            cerr << fileName << " is not a delivery log, not replaying\n";
+            return;
+        }
+        if(header.seed != config.seed) {
+            cerr << fileName << " was recorded with seed=" << header.seed
+                << ", the durations will differ\n";
+        }
+
+        Delivery delivery;
+        while(recorded.read(reinterpret_cast<char*>(&delivery), sizeof(delivery))) {
+            deliveries.push_back(delivery);
+        }
+    }
+
+// Give the replay up - the run has taken another course
+void DeliveryLog::diverged(const char* reason) {
+    cerr << "Agent " << id << ": the replay diverged at delivery " << next << " of " << deliveries.size()
+        << " (" << reason << "), delivering in the arrival order\n";
+    next = deliveries.size();
+}
@@ -0,0 +1,99 @@
+#ifndef DELIVERY_LOG_HPP
+#define DELIVERY_LOG_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Config.hpp"
+
+using namespace std;
+
+// Order in which the messages of an agent were delivered - recorded to
+// `<recordFile>.<id>`, or read back from `<replayFile>.<id>` to deliver the
+// messages in the same order again (see `Messenger::receive`).
+//
+// A message is named by its source, its tag and its number among the
+// arrived messages of that source and tag (which arrive in the order they
+// were sent). A poll which found no message is recorded too, so that the
+// replayed poll finds none at the same point.
+class DeliveryLog {
+public:
+
+    // A delivered message, or a poll which found none (`source` is `Missed`)
+    struct Delivery {
+        int32_t source;
+        int32_t tag;
+        uint64_t sequence;
+    };
+
+    static const int32_t Missed = -1;
+
+    // The most messages held back for a replay before it is given up
+    static const size_t MaxHeld = 1024;
+
+private:
+
+    // Identifier of the agent
+    const int64_t id;
+
+    // Replaying the deliveries (recording them otherwise)
+    const bool replay;
+
+    // Recorded deliveries
+    ofstream file;
+
+    // Deliveries to replay, the next one
+    vector<Delivery> deliveries;
+    size_t next = 0;
+
+    // How long a replay waits for the expected message (in microseconds of real time)
+    uint64_t patience;
+
+public:
+
+    // Record the deliveries of the agent, or replay them (`replayFile` set)
+    DeliveryLog(int64_t id, const Config& config);
+
+    bool replaying() const {
+        return replay && next < deliveries.size();
+    }
+
+    uint64_t getPatience() const {
+        return patience;
+    }
+
+    // Record a delivery
+    void record(const Delivery& delivery) {
+        if(!replay) {
+            file.write(reinterpret_cast<const char*>(&delivery), sizeof(delivery));
+        }
+    }
+
+    // The next delivery to replay (requires `replaying`)
+    const Delivery& expected() const {
+        return deliveries[next];
+    }
+
+    // The expected delivery has been made
+    void advance() {
+        next += 1;
+    }
+
+    // Give the replay up - the run has taken another course
+    void diverged(const char* reason);
+};
+
+// Delivery log file format - the header, then the deliveries
+namespace DeliveryFile {
+    const char Magic[8] = { 'B', 'H', 'D', 'E', 'L', 'I', 'V', 1 };
+
+    struct Header {
+        char magic[8];
+        // Seed of the random durations of the recorded run
+        uint64_t seed;
+    };
+}
+
+#endif
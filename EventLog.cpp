@@ -0,0 +1,28 @@
+#include "EventLog.hpp"
+
+#include <cstring>
+
+EventLog::EventLog(int64_t id, const string& fileName, uint32_t shopSize, const Clock& clock) :
+    id(id),
+    clock(clock),
+    file(fileName + "." + to_string(id), ios::binary)
+    {
+        EventFile::Header header;
+        memcpy(header.magic, EventFile::Magic, sizeof(header.magic));
+        header.recordSize = sizeof(EventRecord);
+        header.shopSize = shopSize;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+// Write a record of the current time
+void EventLog::write(EventKind kind, uint64_t lamport, HunterState state, const Order* order) {
+    EventRecord record = {};
+    record.time = clock.now() + clock.origin();
+    record.lamport = lamport;
+    record.orderLamport = order ? order->lamport : 0;
+    record.customer = order ? order->customer : -1;
+    record.agent = id;
+    record.kind = kind;
+    record.state = static_cast<uint8_t>(state);
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+}
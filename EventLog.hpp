@@ -0,0 +1,89 @@
+#ifndef EVENT_LOG_HPP
+#define EVENT_LOG_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "Clock.hpp"
+#include "Common.hpp"
+#include "Message.hpp"
+
+using namespace std;
+
+// Kind of a recorded event
+enum class EventKind : uint8_t {
+    // The Hunter entered a state (`state`)
+    State,
+    // The Hunter is leaving the store (before letting the others in)
+    StoreLeft,
+    // The Customer placed an order
+    OrderPlaced,
+    // The Hunter sent the completion of an order
+    OrderServed,
+    // The Customer received the completion of an order
+    OrderCompleted
+};
+
+// A recorded event - fixed-size, so that a log can be mapped and read in place
+struct EventRecord {
+    // Time on the scale shared by the processes of a machine (see `Clock::origin`)
+    uint64_t time;
+    uint64_t lamport;
+    // The order of the order events
+    uint64_t orderLamport;
+    int32_t customer;
+    // The agent which recorded the event
+    int32_t agent;
+    EventKind kind;
+    uint8_t state;
+    uint8_t padding[6];
+};
+
+static_assert(sizeof(EventRecord) == 40, "event records are written as they are");
+
+// Event log file format - the header, then the records up to the end of the file
+namespace EventFile {
+    const char Magic[8] = { 'B', 'H', 'E', 'V', 'E', 'N', 'T', '\1' };
+
+    struct Header {
+        char magic[8];
+        uint32_t recordSize;
+        uint32_t shopSize;
+    };
+}
+
+// Event log of a single agent, written to `<eventFile>.<id>` for the offline
+// verifier (see Verify.cpp). Records are buffered and written as they are;
+// not thread-safe - the Hunter records under `stateMutex`.
+class EventLog {
+private:
+
+    const int64_t id;
+    const Clock& clock;
+    ofstream file;
+
+    // Write a record of the current time
+    void write(EventKind kind, uint64_t lamport, HunterState state, const Order* order);
+
+public:
+
+    EventLog(int64_t id, const string& fileName, uint32_t shopSize, const Clock& clock);
+
+    // The Hunter entered the state
+    void state(HunterState state, uint64_t lamport) {
+        write(EventKind::State, lamport, state, nullptr);
+    }
+
+    // The Hunter is leaving the store
+    void storeLeft(uint64_t lamport) {
+        write(EventKind::StoreLeft, lamport, HunterState::Waiting, nullptr);
+    }
+
+    // An event of the order
+    void order(EventKind kind, const Order& order, uint64_t lamport) {
+        write(kind, lamport, HunterState::Waiting, &order);
+    }
+};
+
+#endif
@@ -1,98 +1,287 @@
 #include "Hunter.hpp"
 
-Hunter::Hunter(int64_t id, const Config& config) :
+Hunter::Hunter(int64_t id, const Config& config, Transport& transport, LogSink* logSink, const Topology& topology, Metrics& metrics) :
     id(id),
     config(config),
-    types(),
-    logger(this, id, " H")
-    { }
+    orderRing(config.orderAssignment == OrderAssignment::Queue ? make_unique<OrderRing>(config, topology) : nullptr),
+    messenger(transport.connect(id)),
+    logger(this, logSink, id, " H"),
+    clock(config.virtualTime),
+    metrics(metrics),
+    orders(config.hunterMin),
+    receivedOrders(config.hunterMin, 0),
+    placedOrders(config.hunterMin, 0),
+    holdingToken(id == config.hunterMin)
+    {
+        // Initially the store tokens are dealt out to the Hunters in turn
+        int64_t hunters = config.hunterMax - config.hunterMin + 1;
+        for(int64_t token = 0; token < config.shopSize; token++) {
+            int64_t holder = config.hunterMin + token % hunters;
+            if(holder == id) {
+                storeTokens.insert(token);
+            }
+            if(id == config.hunterMin) {
+                storeTokenQueue.push_back(token);
+                storeTokenAssignee.push_back(holder);
+            }
+        }
+
+        if(!config.traceFile.empty()) {
+            tracer = make_unique<Tracer>(id, "Hunter", config, clock);
+            messenger->setTracer(tracer.get());
+        }
+        if(!config.eventFile.empty()) {
+            events = make_unique<EventLog>(id, config.eventFile, config.shopSize, clock);
+        }
+        if(!config.recordFile.empty() || !config.replayFile.empty()) {
+            deliveries = make_unique<DeliveryLog>(id, config);
+            messenger->setDeliveryLog(deliveries.get());
+        }
+
+        hunterLastOrders.assign(config.hunterMax + 1, 0);
+        seed_seq selectionSeed { config.seed, uint64_t(id), uint64_t(1) };
+        selectionRandom.seed(selectionSeed);
+
+        // Initially every pair of Hunters has its permission with the lower one
+        for(int64_t hunter = id + 1; hunter <= config.hunterMax; hunter++) {
+            storePermissions.insert(hunter);
+        }
+
+        if(config.storeAdmission == StoreAdmission::Quorum) {
+            buildQuorum();
+        }
+        if(config.storeAdmission == StoreAdmission::Shared) {
+            storeSemaphore = make_unique<StoreSemaphore>(topology, config.shopSize);
+        }
+
+        // The first Hunter detects termination and tells the others collectively
+        if(id != config.hunterMin) {
+            messenger->expectCollective(Tag::Terminate);
+        }
+    }
 
 uint64_t Hunter::getLamport() {
-    const lock_guard<mutex> lock(lamportMutex);
-    return lamport;
+    return lamport.load();
 }
 
 void Hunter::loop() {
     thread backgroundThread(&Hunter::loopBackground, this);
     loopForeground();
     backgroundThread.join();
+
+    // The last state ends with the run
+    if(tracer) tracer->span(Tracer::States, name(state), stateSince, clock.now());
+    metrics.finish(clock.now());
 }
 
 // Increment the max(current, given) lamport value by 1
 void Hunter::incrementLamport(uint64_t received) {
-    const lock_guard<mutex> lock(lamportMutex);
-    lamport = max(lamport, received) + 1;
+    uint64_t current = lamport.load();
+    while(!lamport.compare_exchange_weak(current, max(current, received) + 1)) { }
 }
 
 // Increment the current lamport value by 1
 void Hunter::incrementLamport() {
-    const lock_guard<mutex> lock(lamportMutex);
-    lamport += 1;
+    lamport.fetch_add(1);
+}
+
+// Change the current state (requires `stateMutex`)
+void Hunter::setState(HunterState next) {
+    uint64_t now = clock.now();
+    metrics.stateLeft(state, now - stateSince);
+    if(tracer) tracer->span(Tracer::States, name(state), stateSince, now);
+    if(events) events->state(next, getLamport());
+    state = next;
+    stateSince = now;
+}
+
+// Messages which are a part of the termination detection or sent between a Customer and a Hunter
+static bool isControl(int tag) {
+    return
+        tag == Tag::Order || tag == Tag::OrderCompletion || tag == Tag::Finish ||
+        tag == Tag::Token || tag == Tag::Terminate;
+}
+
+// Note that the foreground thread waits until ready, or stops waiting
+// (nullptr; requires `stateMutex`)
+void Hunter::foregroundWaits(function<bool()> ready) {
+    if(!deliveries) return;
+    foregroundReady = ready;
+    foregroundWait.notify_one();
+}
+
+// Count a message sent by this Hunter (requires `stateMutex`)
+void Hunter::countSent(int tag) {
+    metrics.sent(tag);
+    if(!isControl(tag)) {
+        messageCount += 1;
+    }
+}
+
+// Count a message received by this Hunter (requires `stateMutex`)
+void Hunter::countReceived(int tag) {
+    metrics.received(tag);
+    if(!isControl(tag)) {
+        messageCount -= 1;
+        black = true;
+    }
+}
+
+// Check if the Hunter has no more work to do (requires `stateMutex`)
+bool Hunter::passive() const {
+    if(
+        state != HunterState::Waiting || !orders.empty() || !stealVictims.empty() ||
+        finishedCustomers < config.hunterMin) {
+        return false;
+    }
+    if(orderRing) {
+        // All the orders have been claimed from the global queue
+        uint64_t placed = 0;
+        for(int64_t customer = 0; customer < config.hunterMin; customer++) {
+            placed += placedOrders[customer];
+        }
+        return orderRing->claimed() >= placed;
+    }
+    for(int64_t customer = 0; customer < config.hunterMin; customer++) {
+        if(receivedOrders[customer] < placedOrders[customer]) return false;
+    }
+    return true;
+}
+
+// Pass the token to the next Hunter if passive (requires `stateMutex`)
+void Hunter::passToken() {
+    if(!holdingToken || terminated || !passive()) return;
+
+    if(id == config.hunterMin) {
+
+        // The token has returned unchanged - all the Hunters are passive
+        // and there are no messages in transit
+        if(
+            config.hunterMin == config.hunterMax ||
+            (tokenReturned && !token.black && !black && token.count + messageCount == 0)) {
+
+            logger() << "🛑 Termination detected, stopping all the Hunters\n";
+
+            incrementLamport();
+            Terminate terminate { getLamport(), clock.now() };
+            messenger->sendCollective(terminate, Tag::Terminate);
+            for(int i = config.hunterMin; i <= config.hunterMax; i++) {
+                countSent(Tag::Terminate);
+            }
+            holdingToken = false;
+            return;
+        }
+
+        // Start a new round
+        token.count = 0;
+        token.black = false;
+        tokenReturned = false;
+    } else {
+        token.count += messageCount;
+        token.black = token.black || black;
+    }
+
+    black = false;
+    holdingToken = false;
+
+    int64_t next = id == config.hunterMax ? config.hunterMin : id + 1;
+    incrementLamport();
+    token.lamport = getLamport();
+    token.time = clock.now();
+    logger.debug() << "Passing " << token << " to " << next << "\n";
+    messenger->send(token, next, Tag::Token);
+    countSent(Tag::Token);
 }
 
 //
 // Handling messages
 //
 
-// Handle the `Order` message
+// Handle the `Order` message (a batch of orders)
 void Hunter::handleOrder() {
-    Order order;
-    MPI_Recv(&order, 1, types.order, MPI_ANY_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, &status);
-    incrementLamport(order.lamport);
-    
+    OrderBatch batch;
+    messenger->take(batch);
+    incrementLamport(batch.lamport);
+    clock.merge(batch.time);
+
     {
         lock_guard<mutex> lock(stateMutex);
 
-        logger() <<  "Received " << order << " - ";
-
-        // If the order is rejected - remove from the list fo rejected
-        if(auto it = find(rejected.begin(), rejected.end(), order); it != rejected.end()) {
-            rejected.erase(it);
-            logger << "removing from rejected list\n";
-        } else {
-            // Add the order to the list
-            orders.push_back(order);
-            logger << "adding to the list\n";
+        for(uint64_t i = 0; i < batch.count && i < OrderBatch::MaxOrders; i++) {
+            Order order = batch.order(i);
+            receivedOrders[order.customer] += 1;
 
-            // Notify the waiting thread
-            if(state == HunterState::Waiting) {
-                waitingForNewOrderWait.notify_one();
+            if(config.orderAssignment == OrderAssignment::Owner) {
+                addOwnedOrder(order);
+            } else {
+                addContestedOrder(order);
             }
         }
-        
+    }
+}
+
+// Add an order received from a Customer (the contest assignment, requires `stateMutex`)
+void Hunter::addContestedOrder(const Order& order) {
+    // Add the order to the list - unless it has been rejected before
+    bool added = orders.receive(order);
+    logger.debug() << "Received " << order << " - " << (added ? "adding to the list\n" : "removing from rejected list\n");
+
+    if(added) {
+
+        // Notify the waiting thread
+        if(state == HunterState::Waiting) {
+            waitingForNewOrderWait.notify_one();
+        }
     }
 }
 
 // Handle the `OrderRequest` message
 void Hunter::handleOrderRequest() {
     OrderRequest request;
-    MPI_Recv(&request, 1, types.orderRequest, MPI_ANY_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, &status);
+    messenger->take(request);
     incrementLamport(request.lamport);
+    clock.merge(request.time);
 
     {
         lock_guard<mutex> lock(stateMutex);
 
-        logger() << "Received " << request << " - ";
+        hunterLastOrders[status.MPI_SOURCE] = request.lastOrderLamport;
 
-        // If we are getting the same order
-        if(
+        // The store asked for along with the orders - granted now or once we leave the store
+        bool storeGranted = false;
+        if(request.store) {
+            if(storeDeferred(status.MPI_SOURCE, request.lamport)) {
+                waitingForStoreHunters[status.MPI_SOURCE] = request.lamport;
+            } else {
+                storeGranted = true;
+            }
+        }
+
+        // If we are getting the same orders (the contest has started) - the same group, as it has the same first order
+        bool contested =
             state == HunterState::GettingOrder &&
-            orders.front().customer == request.orderCustomer &&
-            orders.front().lamport == request.orderLamport) {
+            gettingOrderContest &&
+            gettingOrders.front() == request.order(0);
+
+        logger.debug() << "Received " << request << " - "
+            << (contested ? "same ones as we are waiting for\n" : "we are not trying to get that order - sending back ACK\n");
 
-            logger << "same one as we are waiting for\n";
+        if(contested) {
 
             // If another Hunter has lower priority - count it as an ACK
             if(request.lastOrderLamport > lastOrderLamport ||
                 (request.lastOrderLamport == lastOrderLamport && id < status.MPI_SOURCE)) {
                 
-                logger() << "Another Hunter failed to get the order\n";
-
-                gettingOrderRemaining -= 1;
-                if(gettingOrderRemaining == 0) {
-                    logger() << "Got the order\n";
-                    gettingOrderGotOrder = true;
-                    gettingOrderWait.notify_one();
+                logger.debug() << "Another Hunter failed to get the order\n";
+
+                // The Hunter may also send an ACK after it has failed - count it once
+                if(gettingOrderResponded.insert(status.MPI_SOURCE).second) {
+                    gettingOrderRemaining -= 1;
+                    if(gettingOrderRemaining == 0) {
+                        logger() << "Got the order\n";
+                        gettingOrderGotOrder = true;
+                        gettingOrderWait.notify_one();
+                    }
                 }
             }
             // If another hunter has higher priority - we failed
@@ -102,25 +291,36 @@ void Hunter::handleOrderRequest() {
                 gettingOrderWait.notify_one();
             }
 
-        } else {
+            // No acknowledgement of the orders to carry the store permission
+            if(storeGranted) {
+                incrementLamport();
+                StoreRequestAck ack { request.lamport, getLamport(), clock.now() };
+                messenger->send(ack, status.MPI_SOURCE, Tag::StoreRequestAck);
+                countSent(Tag::StoreRequestAck);
+                storeGiven(status.MPI_SOURCE);
+            }
 
-            logger << "we are not trying to get that order - sending back ACK\n";
+        } else {
 
-            // We are not getting the same order -- we can send an ACK
+            // We are not getting the same orders -- we can send an ACK (for the first order of the request)
             incrementLamport();
-            OrderRequestAck ack { request.orderCustomer, request.orderLamport, getLamport() };
-            MPI_Send(&ack,
-                1,
-                types.orderRequestAck,
-                status.MPI_SOURCE,
-                Tag::OrderRequestAck,
-                MPI_COMM_WORLD);
-
-            Order order { ack.orderCustomer, ack.orderLamport };
-            if(auto it = find(orders.begin(), orders.end(), order); it != orders.end()) {
-                orders.erase(it);
-            } else if (find(rejected.begin(), rejected.end(), order) == rejected.end()) {
-                rejected.push_back(order);
+            uint64_t storeRequestLamport = storeGranted ? request.lamport : 0;
+            OrderRequestAck ack {
+                request.orderCustomers[0], request.orderLamports[0], storeRequestLamport, getLamport(), clock.now() };
+            messenger->send(ack, status.MPI_SOURCE, Tag::OrderRequestAck);
+            countSent(Tag::OrderRequestAck);
+            if(storeGranted) {
+                storeGiven(status.MPI_SOURCE);
+            }
+
+            for(uint64_t i = 0; i < request.count; i++) {
+                Order order = request.order(i);
+
+                // A late request from a Hunter which has already lost the order we got,
+                // otherwise the order is not ours any more
+                if(!serving(order)) {
+                    orders.reject(order);
+                }
             }
         }
     }
@@ -129,20 +329,26 @@ void Hunter::handleOrderRequest() {
 // Handle the `OrderRequestAck` message
 void Hunter::handleOrderRequestAck() {
     OrderRequestAck ack;
-    MPI_Recv(&ack, 1, types.orderRequestAck, MPI_ANY_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, &status);
+    messenger->take(ack);
     incrementLamport(ack.lamport);
+    clock.merge(ack.time);
     
     {
         lock_guard<mutex> lock(stateMutex);
 
-        logger() << "Received " << ack << "\n";
+        logger.debug() << "Received " << ack << "\n";
+
+        if(ack.storeRequestLamport != 0) {
+            grantStore(status.MPI_SOURCE, ack.storeRequestLamport);
+        }
 
-        // If we are trying to get the order and the ACK is about our order
+        // If we are trying to get the orders and the ACK is about our request
         if(
             state == HunterState::GettingOrder &&
-            ack.orderCustomer == orders.front().customer &&
-            ack.orderLamport == orders.front().lamport) {
-            
+            !gettingOrders.empty() &&
+            gettingOrders.front() == Order(ack.orderCustomer, ack.orderLamport) &&
+            gettingOrderResponded.insert(status.MPI_SOURCE).second) {
+
             gettingOrderRemaining -= 1;
             if(gettingOrderRemaining == 0) {
                 logger() << "Got the order\n";
@@ -155,44 +361,30 @@ void Hunter::handleOrderRequestAck() {
 
 // Handle the `StoreRequest` message
 void Hunter::handleStoreRequest() {
-    uint64_t requestLamport;
-    MPI_Recv(&requestLamport, 1, MPI_UINT64_T, MPI_ANY_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, &status);
-    incrementLamport(requestLamport);
+    StoreRequest request;
+    messenger->take(request);
+    incrementLamport(request.lamport);
+    clock.merge(request.time);
+    uint64_t requestLamport = request.lamport;
 
     {
         lock_guard<mutex> lock(stateMutex);
 
-        logger() << "Received StoreRequest(lamport = "
-            << requestLamport << ") from " << status.MPI_SOURCE << "\n";
+        logger.debug() << "Received " << request << " from " << status.MPI_SOURCE << "\n";
 
-        if(
-            // If in store...
-            state == HunterState::InStore ||
-            // ... or waiting to the store with (lower Lamport) OR (same Lamport, lower ID)
-            (
-                state == HunterState::GettingStore &&
-                (
-                    waitingForStoreLamport < requestLamport ||
-                    (waitingForStoreLamport == requestLamport && id < status.MPI_SOURCE)
-                )
-            )
-        ) {
+        if(storeDeferred(status.MPI_SOURCE, requestLamport)) {
             // Save on the list
             waitingForStoreHunters[status.MPI_SOURCE] = requestLamport;
 
         } else {
             // Send ACK
-            logger() << "Sending store request ACK to "
+            logger.debug() << "Sending store request ACK to "
                 << status.MPI_SOURCE << "\n";
             incrementLamport();
-            StoreRequestAck ack { requestLamport, getLamport() };
-            MPI_Send(
-                &ack,
-                1,
-                types.storeRequestAck,
-                status.MPI_SOURCE,
-                Tag::StoreRequestAck,
-                MPI_COMM_WORLD);
+            StoreRequestAck ack { requestLamport, getLamport(), clock.now() };
+            messenger->send(ack, status.MPI_SOURCE, Tag::StoreRequestAck);
+            countSent(Tag::StoreRequestAck);
+            storeGiven(status.MPI_SOURCE);
         }
     }
 }
@@ -200,29 +392,90 @@ void Hunter::handleStoreRequest() {
 // Handle the `StoreRequestAck` message
 void Hunter::handleStoreRequestAck() {
     StoreRequestAck ack;
-    MPI_Recv(&ack, 1, types.storeRequestAck, MPI_ANY_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, &status);
+    messenger->take(ack);
     incrementLamport(ack.lamport);
+    clock.merge(ack.time);
 
     {
         lock_guard<mutex> lock(stateMutex);
 
-        logger() << "Received " << ack
+        logger.debug() << "Received " << ack
             << " from " << status.MPI_SOURCE << "\n";
 
-        if(state == HunterState::GettingStore && ack.requestLamport == waitingForStoreLamport) {
-            waitingForStoreRemaining -= 1;
-            if(waitingForStoreRemaining == 0) {
-                logger() << "Can get into the store\n";
-                waitingForStoreWait.notify_one();
-            }
+        grantStore(status.MPI_SOURCE, ack.requestLamport);
+    }
+}
+
+// Handle the `Finish` message
+void Hunter::handleFinish() {
+    Finish finish;
+    messenger->take(finish);
+    incrementLamport(finish.lamport);
+    clock.merge(finish.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        logger() << "Customer " << status.MPI_SOURCE << " finished after "
+            << finish.orders << " orders\n";
+
+        placedOrders[status.MPI_SOURCE] = finish.orders;
+        finishedCustomers += 1;
+    }
+}
+
+// Handle the `Token` message
+void Hunter::handleToken() {
+    Token received;
+    messenger->take(received);
+    incrementLamport(received.lamport);
+    clock.merge(received.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        logger.debug() << "Received " << received << "\n";
+
+        token = received;
+        holdingToken = true;
+        if(id == config.hunterMin) {
+            tokenReturned = true;
         }
     }
 }
 
+// Handle the `Terminate` message
+void Hunter::handleTerminate() {
+    Terminate terminate;
+    messenger->take(terminate);
+    incrementLamport(terminate.lamport);
+    clock.merge(terminate.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        logger() << "Terminating\n";
+
+        terminated = true;
+        waitingForNewOrderWait.notify_one();
+    }
+}
+
 // Loop performed by the background (messaging thread)
 void Hunter::loopBackground() {
-    while(true) {
-        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+    while(!terminated) {
+        // With a delivery log the foreground thread acts on every message
+        // before the next one, so the same deliveries make the same run
+        if(deliveries) {
+            unique_lock<mutex> lock(stateMutex);
+            foregroundWait.wait(lock, [this] { return terminated || (foregroundReady && !foregroundReady()); });
+        }
+
+        messenger->receive(status);
+        if(status.MPI_TAG >= Tag::First && status.MPI_TAG <= Tag::Last) {
+            lock_guard<mutex> lock(stateMutex);
+            countReceived(status.MPI_TAG);
+        }
         switch (status.MPI_TAG) {
         case Tag::Order: 
             handleOrder();
@@ -239,11 +492,311 @@ void Hunter::loopBackground() {
         case Tag::StoreRequestAck:
             handleStoreRequestAck();
             break;
+        case Tag::Finish:
+            handleFinish();
+            break;
+        case Tag::Token:
+            handleToken();
+            break;
+        case Tag::Terminate:
+            handleTerminate();
+            break;
+        case Tag::StoreTokenRequest:
+            handleStoreTokenRequest();
+            break;
+        case Tag::StoreTokenForward:
+            handleStoreTokenForward();
+            break;
+        case Tag::StoreToken:
+            handleStoreToken();
+            break;
+        case Tag::QuorumRequest:
+        case Tag::QuorumLocked:
+        case Tag::QuorumFailed:
+        case Tag::QuorumInquire:
+        case Tag::QuorumRelinquish:
+        case Tag::QuorumRelease:
+            handleQuorumMessage();
+            break;
+        case Tag::OrderSteal:
+            handleOrderSteal();
+            break;
+        case Tag::OrderStealReply:
+            handleOrderStealReply();
+            break;
         default:
             logger() << "ERROR: Unknown message type: " << status.MPI_TAG << "\n";
             break;
         }
+
+        // The message could have made the Hunter passive
+        lock_guard<mutex> lock(stateMutex);
+        passToken();
+    }
+}
+
+//
+// Order assignment
+//
+
+// Check if there is an order to try to get (requires `stateMutex`)
+bool Hunter::orderAvailable() const {
+    if(config.orderAssignment == OrderAssignment::Owner) {
+        return !orders.empty() || !stealVictims.empty();
+    }
+    return !orders.empty();
+}
+
+// The most orders served in one mission
+size_t Hunter::missionOrders() const {
+    return clamp<size_t>(config.missionOrders, 1, OrderRequest::MaxOrders);
+}
+
+// Check if the orders are contested together - the orders of a Customer with Lamport
+// values in the same aligned range of `missionOrders` (placed in one batch, see `Customer`)
+bool Hunter::sameGroup(const Order& first, const Order& order) const {
+    uint64_t size = missionOrders();
+    return first.customer == order.customer && (first.lamport - 1) / size == (order.lamport - 1) / size;
+}
+
+// Check if the order is one of those being served (requires `stateMutex`)
+bool Hunter::serving(const Order& order) const {
+    for(size_t i = 0; i < servingOrders; i++) {
+        if(*orders.at(i) == order) return true;
+    }
+    return false;
+}
+
+// Try to get orders to serve, placing them in front of `orders`
+// (returns their number, 0 if none; requires `stateMutex`)
+size_t Hunter::acquireOrder(unique_lock<mutex>& lock) {
+    switch(config.orderAssignment) {
+    case OrderAssignment::Contest:
+        return acquireOrderByContest(lock);
+    case OrderAssignment::Owner:
+        return acquireOrderByOwner(lock);
+    case OrderAssignment::Queue:
+        return acquireOrderByQueue(lock);
+    }
+    return 0;
+}
+
+// Contest with the other Hunters for a pending order and the rest of its group
+size_t Hunter::acquireOrderByContest(unique_lock<mutex>& lock) {
+    gettingOrderRemaining = config.hunterMax - config.hunterMin;
+    gettingOrderResponded.clear();
+    // A single Hunter gets every order without a contest
+    gettingOrderGotOrder = gettingOrderRemaining == 0;
+
+    selectOrders();
+
+    {
+        auto line = logger();
+        line << "Trying to get " << gettingOrders.front();
+        if(gettingOrders.size() > 1) {
+            line << " and " << gettingOrders.size() - 1 << " more";
+        }
+        line << "\n";
+    }
+
+    // Send a request to the other Hunters
+    gettingOrderContest = true;
+    OrderRequest orderRequest;
+    orderRequest.count = gettingOrders.size();
+    for(size_t i = 0; i < gettingOrders.size(); i++) {
+        orderRequest.orderCustomers[i] = gettingOrders[i].customer;
+        orderRequest.orderLamports[i] = gettingOrders[i].lamport;
     }
+    orderRequest.lastOrderLamport = lastOrderLamport;
+    orderRequest.store = combinedRequests() && !storePermitted();
+    orderRequest.lamport = getLamport();
+    orderRequest.time = clock.now();
+    if(orderRequest.store) {
+        requestStore(orderRequest.lamport);
+    }
+    messenger->broadcast(orderRequest, Tag::OrderRequest);
+    for(int i = config.hunterMin; i <= config.hunterMax; i++) {
+        if(i == id) continue;
+        countSent(Tag::OrderRequest);
+        incrementLamport();
+    }
+    logger.debug() << "Order request sent to other Hunters\n";
+
+    // Wait for all responses
+    await(gettingOrderWait, lock, [this]{ return gettingOrderRemaining <= 0; });
+    gettingOrderContest = false;
+
+    metrics.contest(!gettingOrderGotOrder);
+
+    if(!gettingOrderGotOrder) {
+        logger() << "Didn't get " << gettingOrders.front() << "\n";
+        for(const Order& order: gettingOrders) {
+            orders.erase(order);
+        }
+        if(orderRequest.store) {
+            withdrawStore();
+        }
+        return 0;
+    }
+
+    // The orders being served go first
+    for(auto order = gettingOrders.rbegin(); order != gettingOrders.rend(); order++) {
+        orders.erase(*order);
+        orders.push_front(*order);
+    }
+    return gettingOrders.size();
+}
+
+//
+// Store admission
+//
+
+// Wait until admitted to the store (requires `stateMutex`)
+void Hunter::acquireStore(unique_lock<mutex>& lock) {
+    switch(config.storeAdmission) {
+    case StoreAdmission::Requests:
+        acquireStoreByRequests(lock);
+        break;
+    case StoreAdmission::Token:
+        acquireStoreByToken(lock);
+        break;
+    case StoreAdmission::Quorum:
+        acquireStoreByQuorum(lock);
+        break;
+    case StoreAdmission::Shared:
+        acquireStoreByShared(lock);
+        break;
+    }
+}
+
+// Leave the store (requires `stateMutex`)
+void Hunter::releaseStore() {
+    switch(config.storeAdmission) {
+    case StoreAdmission::Requests:
+        releaseStoreByRequests();
+        break;
+    case StoreAdmission::Token:
+        releaseStoreByToken();
+        break;
+    case StoreAdmission::Quorum:
+        releaseStoreByQuorum();
+        break;
+    case StoreAdmission::Shared:
+        releaseStoreByShared();
+        break;
+    }
+}
+
+// Ask all the other Hunters for a permission to enter the store
+void Hunter::acquireStoreByRequests(unique_lock<mutex>& lock) {
+
+    // Unless asked for along with the orders
+    if(!waitingForStoreRequested) {
+
+        // Nobody has asked for the store since we got the permissions - no need to ask again
+        if(storePermitted()) {
+            logger() << "Can get into the store - permissions kept\n";
+            return;
+        }
+
+        requestStore(getLamport());
+
+        // Send request to all the Hunters
+        StoreRequest storeRequest { waitingForStoreLamport, clock.now() };
+        messenger->broadcast(storeRequest, Tag::StoreRequest);
+        for(int i = config.hunterMin; i <= config.hunterMax; i++) {
+            if(i == id) continue;
+            countSent(Tag::StoreRequest);
+        }
+        logger.debug() << "Store request to other Hunters sent, waiting...\n";
+    }
+
+    // Wait for all responses - from now on the Hunter is in the store
+    await(waitingForStoreWait, lock, [this] { return waitingForStoreRemaining <= 0; });
+    waitingForStoreRequested = false;
+}
+
+// The store is asked for along with the orders (the contest with the requests admission)
+bool Hunter::combinedRequests() const {
+    return
+        config.combinedRequests &&
+        config.orderAssignment == OrderAssignment::Contest &&
+        config.storeAdmission == StoreAdmission::Requests;
+}
+
+// Start asking for the store with the request of the given Lamport value (requires `stateMutex`)
+void Hunter::requestStore(uint64_t requestLamport) {
+    waitingForStoreRequested = true;
+    waitingForStoreLamport = requestLamport;
+    waitingForStoreRemaining = config.hunterMax - config.hunterMin + 1 - config.shopSize;
+    waitingForStoreHunters.clear();
+}
+
+// Withdraw the store request after the orders are lost (requires `stateMutex`)
+void Hunter::withdrawStore() {
+    // The permissions already given are not needed - the late ones are told apart by the Lamport value
+    waitingForStoreRequested = false;
+    releaseStoreByRequests();
+}
+
+// Check if a store request of another Hunter has to wait for this one (requires `stateMutex`)
+bool Hunter::storeDeferred(int64_t hunter, uint64_t requestLamport) const {
+    return
+        // If in store...
+        state == HunterState::InStore ||
+        // ... or waiting to the store with (lower Lamport) OR (same Lamport, lower ID)
+        (
+            waitingForStoreRequested &&
+            (
+                waitingForStoreLamport < requestLamport ||
+                (waitingForStoreLamport == requestLamport && id < hunter)
+            )
+        );
+}
+
+// Count a permission to enter the store (requires `stateMutex`)
+void Hunter::grantStore(int64_t hunter, uint64_t requestLamport) {
+
+    // Kept unless we have given the Hunter its permission since the request (the ACKs crossed)
+    if(storePermissionsGiven[hunter] < requestLamport) {
+        storePermissions.insert(hunter);
+    }
+
+    if(!waitingForStoreRequested || requestLamport != waitingForStoreLamport) return;
+
+    waitingForStoreRemaining -= 1;
+    if(waitingForStoreRemaining == 0) {
+        logger() << "Can get into the store\n";
+        waitingForStoreWait.notify_one();
+    }
+}
+
+// Let the deferred Hunters into the store
+void Hunter::releaseStoreByRequests() {
+
+    // Send store ACKs to everyone on the waiting list
+    StoreRequestAck ack { 0, getLamport(), clock.now() };
+    for(const auto[hunter, lamport]: waitingForStoreHunters) {
+        ack.requestLamport = lamport;
+        messenger->send(ack, hunter, Tag::StoreRequestAck);
+        countSent(Tag::StoreRequestAck);
+        storeGiven(hunter);
+    }
+    waitingForStoreHunters.clear();
+    logger.debug() << "Send ACK to everyone on the store waiting list\n";
+}
+
+// Note a permission to enter the store given to another Hunter (requires `stateMutex`)
+void Hunter::storeGiven(int64_t hunter) {
+    storePermissions.erase(hunter);
+    storePermissionsGiven[hunter] = waitingForStoreLamport;
+}
+
+// Check if the permissions of all the other Hunters are kept (requires `stateMutex`)
+bool Hunter::storePermitted() const {
+    return
+        config.keepPermissions &&
+        static_cast<int64_t>(storePermissions.size()) == config.hunterMax - config.hunterMin;
 }
 
 //
@@ -252,9 +805,10 @@ void Hunter::loopBackground() {
 
 // Loop performed by the main thread
 void Hunter::loopForeground() {
-    mt19937_64 generator;
-    uniform_int_distribution<int> storeRandom(config.storeWaitMin, config.storeWaitMax);
-    uniform_int_distribution<int> missionRandom(config.missionWaitMin, config.missionWaitMax);
+    seed_seq seed { config.seed, uint64_t(id) };
+    mt19937_64 generator(seed);
+    uniform_int_distribution<uint64_t> storeRandom(config.storeWaitMin, config.storeWaitMax);
+    uniform_int_distribution<uint64_t> missionRandom(config.missionWaitMin, config.missionWaitMax);
 
     while(true) {
 
@@ -263,110 +817,77 @@ void Hunter::loopForeground() {
 
             // STATE: Waiting
 
-            state = HunterState::Waiting;
+            setState(HunterState::Waiting);
             incrementLamport();
             logger() << "Waiting for new orders...\n";
+            passToken();
 
             // Wait for a new order
-            waitingForNewOrderWait.wait(lock, [this]() { return !orders.empty(); });
+            if(orderRing) {
+                waitForQueuedOrder(lock);
+            } else {
+                await(waitingForNewOrderWait, lock, [this]() { return orderAvailable() || terminated; });
+            }
+            if(terminated) break;
             
 
             // STATE: Getting order
 
-            state = HunterState::GettingOrder;
-            gettingOrderRemaining = config.hunterMax - config.hunterMin;
-            gettingOrderGotOrder = false;
+            setState(HunterState::GettingOrder);
             incrementLamport();
 
-            logger() << "Trying to get " << orders.front() << "\n";
-
-            // Send a request to the other Hunters
-            OrderRequest orderRequest { orders.front().customer, orders.front().lamport, lastOrderLamport, getLamport() };
-            for(int i = config.hunterMin; i <= config.hunterMax; i++) {
-                if(i == id) continue;
-                MPI_Send(&orderRequest, 1, types.orderRequest, i, Tag::OrderRequest, MPI_COMM_WORLD);
-                incrementLamport();
-            }
-            logger() << "Order request sent to other Hunters\n";
-
-            // Wait for all responses
-            gettingOrderWait.wait(lock, [this]{ return gettingOrderRemaining <= 0; });
-
-            // If we didn't get the order - start over
-            if(!gettingOrderGotOrder) {
-                logger() << "Didn't get " << orders.front() << "\n";
-                
-                orders.pop_front();
+            // If we didn't get any order - start over
+            servingOrders = acquireOrder(lock);
+            if(servingOrders == 0) {
                 incrementLamport();
                 continue;
             }
-            logger() << "Got " << orders.front() << "\n";
+            {
+                auto line = logger();
+                line << "Got " << orders.front();
+                if(servingOrders > 1) {
+                    line << " and " << servingOrders - 1 << " more";
+                }
+                line << "\n";
+            }
 
             // STATE: getting store
 
             incrementLamport();
-            state = HunterState::GettingStore;
-            waitingForStoreLamport = getLamport();
-            waitingForStoreRemaining = config.hunterMax - config.hunterMin + 1 - config.shopSize;
-            waitingForStoreHunters.clear();
-            
+            setState(HunterState::GettingStore);
 
             logger() << "Trying to get into the store\n";
-
-            // Send request to all the Hunters
-            for(int i = config.hunterMin; i <= config.hunterMax; i++) {
-                if(i == id) continue;
-                MPI_Send(&waitingForStoreLamport, 1, MPI_UINT64_T, i, Tag::StoreRequest, MPI_COMM_WORLD);
-            }
-            logger() << "Store request to other Hunters sent, waiting...\n";
-
-            // Wait for all responses
-            waitingForStoreWait.wait(lock, [this] { return waitingForStoreRemaining <= 0; });
-
+            acquireStore(lock);
 
             // STATE: In store
 
-            state = HunterState::InStore;
+            setState(HunterState::InStore);
             incrementLamport();
 
             logger() << "🏪 In store, shopping\n";
         }
 
-        // Sleep for a random number of seconds - don't block the mutex
-        sleep(storeRandom(generator));
+        // Spend a random amount of time in the store - don't block the mutex
+        clock.wait(storeRandom(generator) * config.timeUnit);
 
         {
             unique_lock<mutex> lock(stateMutex);
 
             incrementLamport();
             logger() << "Out of the store\n";
-
-            // Send store ACKs to everyone on the waiting list
-            StoreRequestAck ack { 0, getLamport() };
-            for(const auto[hunter, lamport]: waitingForStoreHunters) {
-                ack.requestLamport = lamport;
-                MPI_Send(
-                    &ack,
-                    1,
-                    types.storeRequestAck,
-                    hunter,
-                    Tag::StoreRequestAck,
-                    MPI_COMM_WORLD);
-            }
-            waitingForStoreHunters.clear();
-            logger() << "Send ACK to everyone on the store waiting list\n";
-
+            if(events) events->storeLeft(getLamport());
+            releaseStore();
 
             // STATE: Mission
 
-            state = HunterState::Mission;
+            setState(HunterState::Mission);
             incrementLamport();
 
             logger() << "🚀 On a mission\n";
         }
 
-        // Sleep for a random number of seconds - don't block the mutex
-        sleep(missionRandom(generator));
+        // Spend a random amount of time on a mission - don't block the mutex
+        clock.wait(missionRandom(generator) * config.timeUnit);
 
         {
             unique_lock<mutex> lock(stateMutex);
@@ -375,19 +896,23 @@ void Hunter::loopForeground() {
             logger() << "Mission finished\n";
 
             
-            // Send order completion to the Customer
-            incrementLamport();
-            OrderCompletion completion { orders.front().customer, orders.front().lamport, getLamport() };
-            MPI_Send(&completion,
-                1,
-                types.orderCompletion,
-                orders.front().customer,
-                Tag::OrderCompletion,
-                MPI_COMM_WORLD);
-            
-            logger() << "Sent " << completion << "\n";
+            // Send the order completions to the Customers
+            for(; servingOrders > 0; servingOrders--) {
+                incrementLamport();
+                OrderCompletion completion { orders.front().customer, orders.front().lamport, getLamport(), clock.now() };
+
+                // Served before the Customer can record the completion
+                if(events) events->order(EventKind::OrderServed, orders.front(), getLamport());
+                messenger->send(completion, orders.front().customer, Tag::OrderCompletion);
+                countSent(Tag::OrderCompletion);
+
+                logger() << "Sent " << completion << "\n";
+
+                orders.pop_front();
+            }
 
-            orders.pop_front();
+            // The Hunter which has waited longest since its last order wins the next contest
+            lastOrderLamport = getLamport();
         }
 
         //logger() << "--> LOOP DONE \n";
@@ -3,30 +3,36 @@
 
 #include <cstdint>
 #include <list>
+#include <deque>
+#include <set>
 #include <unordered_map>
+#include <vector>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <random>
 #include <thread>
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <mpi.h>
 
-#include <unistd.h>
-
+#include "Clock.hpp"
 #include "Config.hpp"
+#include "DeliveryLog.hpp"
+#include "EventLog.hpp"
 #include "Common.hpp"
 #include "Message.hpp"
+#include "Messenger.hpp"
+#include "Metrics.hpp"
+#include "OrderQueue.hpp"
+#include "OrderRing.hpp"
+#include "StoreSemaphore.hpp"
+#include "Topology.hpp"
+#include "Tracer.hpp"
 
 using namespace std;
 
-enum class HunterState {
-    Waiting,
-    GettingOrder,
-    GettingStore,
-    InStore,
-    Mission
-};
-
 class Hunter : Loggable {
 private:
 
@@ -36,31 +42,63 @@ private:
     // Configuration of the program
     const Config config;
 
-    // Datatypes used by the MPI
-    const Datatype types;
+    // Global queue of the orders (the queue assignment)
+    unique_ptr<OrderRing> orderRing;
+
+    // Sends and receives the messages
+    unique_ptr<Messenger> messenger;
 
     // Logger which prints Lamport values
     const Logger logger;
 
+    // Real or virtual time
+    Clock clock;
+
+    // Counters and histograms
+    Metrics& metrics;
+
+    // Timeline of the Hunter (if traced)
+    unique_ptr<Tracer> tracer;
+
+    // Events for the verifier (if recorded)
+    unique_ptr<EventLog> events;
+
+    // Delivery order of the messages (if recorded or replayed)
+    unique_ptr<DeliveryLog> deliveries;
+
 
     // Lamport value from the completion of last task
     uint64_t lastOrderLamport = 0;
 
+    // Last known `lastOrderLamport` of every Hunter (the priorities of the others in a contest)
+    vector<uint64_t> hunterLastOrders;
+
+    // Random choices of the order selection
+    mt19937_64 selectionRandom;
+
     // Current state
     HunterState state = HunterState::Waiting;
     mutex stateMutex;
 
+    // Time of entering the current state
+    uint64_t stateSince = 0;
+
+    // Readiness of the foreground thread while it waits (with a delivery
+    // log), notified when it starts to wait
+    function<bool()> foregroundReady;
+    condition_variable foregroundWait;
+
     // Lamport value (Do not use directly!)
-    uint64_t lamport = 0;
-    mutex lamportMutex;
+    atomic<uint64_t> lamport { 0 };
 
-    // Pending orders
-    list<Order> orders;
+    // Pending orders, and the orders rejected before they arrived
+    OrderQueue orders;
 
-    // Rejected orders
-    list<Order> rejected;
+    // Number of the first orders which have been got and are being served
+    // (until their completions are sent)
+    size_t servingOrders = 0;
 
-    // Status used by the MPI_Recv
+    // Status of the last received message
     MPI_Status status;
 
     // 
@@ -70,25 +108,238 @@ private:
     // Waiting
     condition_variable  waitingForNewOrderWait;
 
-    // Getting order
+    // Getting order - the requests of other Hunters count for gettingOrders only
+    // while the contest is on, not between a lost contest and the next one
     condition_variable  gettingOrderWait;
     int64_t             gettingOrderRemaining = 0;
+    set<int64_t>        gettingOrderResponded;
     bool                gettingOrderGotOrder = false;
+    bool                gettingOrderContest = false;
+    vector<Order>       gettingOrders;
 
-    // Waiting in line for the store
+    // Stealing orders (the owner assignment)
+    deque<int64_t>      stealVictims;
+    condition_variable  stealingWait;
+    bool                stealingReplied = false;
+    bool                stealingStole = false;
+
+    // Waiting in line for the store (asked for by a store request or along with the orders)
+    bool                                waitingForStoreRequested = false;
     uint64_t                            waitingForStoreLamport = 0;
     condition_variable                  waitingForStoreWait;
     int64_t                             waitingForStoreRemaining = 0;
     unordered_map<int64_t, uint64_t>    waitingForStoreHunters;
 
+    // Permissions kept from the other Hunters until they ask for the store (`keepPermissions`),
+    // and the Lamport value of our last store request when we gave each Hunter its permission
+    set<int64_t>                        storePermissions;
+    unordered_map<int64_t, uint64_t>    storePermissionsGiven;
+
+    // Store tokens (the token admission)
+    set<int64_t>                        storeTokens;
+    int64_t                             storeTokenUsed = -1;
+    condition_variable                  storeTokenWait;
+    unordered_map<int64_t, int64_t>     storeTokenNext;
+
+    // Store token manager (the first Hunter only)
+    deque<int64_t>                      storeTokenQueue;
+    vector<int64_t>                     storeTokenAssignee;
+
+    // Quorum of the Hunter (the quorum admission)
+    vector<int64_t>                     quorum;
+    uint64_t                            quorumRequestLamport = 0;
+    set<int64_t>                        quorumLocked;
+    bool                                quorumFailed = false;
+    set<int64_t>                        quorumInquiries;
+    condition_variable                  quorumWait;
+
+    // Quorum arbiter - (request Lamport, Hunter) locked and waiting
+    pair<uint64_t, int64_t>             arbiterLock { 0, -1 };
+    set<pair<uint64_t, int64_t>>        arbiterQueue;
+    bool                                arbiterInquired = false;
+
+    // Store semaphore in a window of the first Hunter (the shared admission)
+    unique_ptr<StoreSemaphore>          storeSemaphore;
+
+    // 
+    // Termination detection (Safra's algorithm over the ring of Hunters)
+    //
+
+    // Number of Customers which will not place any more orders
+    int64_t finishedCustomers = 0;
+
+    // Number of orders received from and placed by each Customer
+    vector<uint64_t> receivedOrders;
+    vector<uint64_t> placedOrders;
+
+    // Messages sent to minus messages received from other Hunters
+    int64_t messageCount = 0;
+
+    // Received a message from another Hunter since passing the token
+    bool black = false;
+
+    // The token is held by this Hunter
+    bool holdingToken = false;
+
+    // The token has made a full round (the first Hunter only)
+    bool tokenReturned = false;
+
+    // The last received token
+    Token token { 0, 0, 0, 0 };
+
+    // Termination has been detected
+    bool terminated = false;
+
     // Increment the max(current, given) lamport value by 1
     void incrementLamport(uint64_t received);
 
     // Increment the current lamport value by 1
     void incrementLamport();
 
+    // Change the current state (requires `stateMutex`)
+    void setState(HunterState next);
+
+    // Note that the foreground thread waits until ready, or stops waiting
+    // (nullptr; requires `stateMutex`)
+    void foregroundWaits(function<bool()> ready);
+
+    // Wait on the condition until ready (the foreground thread, requires `stateMutex`)
+    template<typename Predicate>
+    void await(condition_variable& condition, unique_lock<mutex>& lock, Predicate ready) {
+        foregroundWaits(ready);
+        condition.wait(lock, ready);
+        foregroundWaits(nullptr);
+    }
+
+    // Count a message sent by this Hunter (requires `stateMutex`)
+    void countSent(int tag);
+
+    // Count a message received by this Hunter (requires `stateMutex`)
+    void countReceived(int tag);
+
+    // Check if the Hunter has no more work to do (requires `stateMutex`)
+    bool passive() const;
+
+    // Pass the token to the next Hunter if passive (requires `stateMutex`)
+    void passToken();
+
+
+    // Check if there is an order to try to get (requires `stateMutex`)
+    bool orderAvailable() const;
+
+    // The most orders served in one mission
+    size_t missionOrders() const;
+
+    // Check if the orders are contested together (the group of the first one)
+    bool sameGroup(const Order& first, const Order& order) const;
+
+    // Check if the order is one of those being served (requires `stateMutex`)
+    bool serving(const Order& order) const;
+
+    // Try to get orders to serve, placing them in front of `orders`
+    // (returns their number, 0 if none; requires `stateMutex`)
+    size_t acquireOrder(unique_lock<mutex>& lock);
+
+    // Order assignment by a contest between the Hunters
+    size_t acquireOrderByContest(unique_lock<mutex>& lock);
+
+    // Choose the group of pending orders to contest into `gettingOrders` (requires `stateMutex`)
+    void selectOrders();
 
-    // Handle the `Order` message
+    // Number of the other Hunters which would win a contest with this one, as last known
+    int64_t priorityRank() const;
+
+    // Order assignment by the owners, stealing when out of own orders
+    size_t acquireOrderByOwner(unique_lock<mutex>& lock);
+
+    // Order assignment by claiming the orders from the global queue
+    size_t acquireOrderByQueue(unique_lock<mutex>& lock);
+
+    // Wait until an order is claimed from the global queue or terminated (requires `stateMutex`)
+    void waitForQueuedOrder(unique_lock<mutex>& lock);
+
+    // Claim the next order from the global queue, if any (requires `stateMutex`)
+    bool claimQueuedOrder();
+
+    // Return the owner of the order (rendezvous hashing)
+    int64_t orderOwner(const Order& order) const;
+
+    // Add an order received from a Customer (the owner assignment, requires `stateMutex`)
+    void addOwnedOrder(const Order& order);
+
+    // Add an order received from a Customer (the contest assignment, requires `stateMutex`)
+    void addContestedOrder(const Order& order);
+
+
+    // Wait until admitted to the store (requires `stateMutex`)
+    void acquireStore(unique_lock<mutex>& lock);
+
+    // Leave the store (requires `stateMutex`)
+    void releaseStore();
+
+    // Store admission by asking all the other Hunters
+    void acquireStoreByRequests(unique_lock<mutex>& lock);
+    void releaseStoreByRequests();
+
+    // The store is asked for along with the orders (the contest with the requests admission)
+    bool combinedRequests() const;
+
+    // Start asking for the store with the request of the given Lamport value (requires `stateMutex`)
+    void requestStore(uint64_t requestLamport);
+
+    // Withdraw the store request after the orders are lost (requires `stateMutex`)
+    void withdrawStore();
+
+    // Check if a store request of another Hunter has to wait for this one (requires `stateMutex`)
+    bool storeDeferred(int64_t hunter, uint64_t requestLamport) const;
+
+    // Count a permission to enter the store (requires `stateMutex`)
+    void grantStore(int64_t hunter, uint64_t requestLamport);
+
+    // Note a permission to enter the store given to another Hunter (requires `stateMutex`)
+    void storeGiven(int64_t hunter);
+
+    // Check if the permissions of all the other Hunters are kept (requires `stateMutex`)
+    bool storePermitted() const;
+
+    // Store admission by the store tokens
+    void acquireStoreByToken(unique_lock<mutex>& lock);
+    void releaseStoreByToken();
+
+    // Assign the next store token to the Hunter (the token manager only, requires `stateMutex`)
+    void assignStoreToken(int64_t hunter);
+
+    // Pass the store token to the given Hunter after it is used (requires `stateMutex`)
+    void forwardStoreToken(int64_t token, int64_t hunter);
+
+    // Send the store token to the given Hunter (requires `stateMutex`)
+    void sendStoreToken(int64_t token, int64_t hunter);
+
+    // Store admission by a quorum of the Hunters
+    void acquireStoreByQuorum(unique_lock<mutex>& lock);
+    void releaseStoreByQuorum();
+
+    // Store admission by a semaphore in shared memory
+    void acquireStoreByShared(unique_lock<mutex>& lock);
+    void releaseStoreByShared();
+
+    // Build the grid quorum of the Hunter
+    void buildQuorum();
+
+    // Send a quorum message, handling messages to itself in place (requires `stateMutex`)
+    void sendQuorum(int64_t hunter, int tag, uint64_t requestLamport);
+
+    // Handle a quorum message (requires `stateMutex`)
+    void onQuorumMessage(int64_t hunter, int tag, uint64_t requestLamport);
+
+    // Give the lock back to the arbiter (requires `stateMutex`)
+    void relinquishQuorum(int64_t arbiter);
+
+    // Lock the arbiter for the next waiting request (requires `stateMutex`)
+    void lockArbiter();
+
+
+    // Handle the `Order` message (a batch of orders)
     void handleOrder();
 
     // Handle the `OrderRequest` message
@@ -103,6 +354,33 @@ private:
     // Handle the `StoreRequestAck` message
     void handleStoreRequestAck();
 
+    // Handle the `Finish` message
+    void handleFinish();
+
+    // Handle the `Token` message
+    void handleToken();
+
+    // Handle the `Terminate` message
+    void handleTerminate();
+
+    // Handle the `StoreTokenRequest` message
+    void handleStoreTokenRequest();
+
+    // Handle the `StoreTokenForward` message
+    void handleStoreTokenForward();
+
+    // Handle the `StoreToken` message
+    void handleStoreToken();
+
+    // Handle the `Quorum*` messages
+    void handleQuorumMessage();
+
+    // Handle the `OrderSteal` message
+    void handleOrderSteal();
+
+    // Handle the `OrderStealReply` message
+    void handleOrderStealReply();
+
 
     // Loop performed by the background (messaging thread)
     void loopBackground();
@@ -112,7 +390,7 @@ private:
 
 public:
 
-    Hunter(int64_t id, const Config& config);
+    Hunter(int64_t id, const Config& config, Transport& transport, LogSink* logSink, const Topology& topology, Metrics& metrics);
 
     // Return the current lamport value
     uint64_t getLamport() override;
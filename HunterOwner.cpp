@@ -0,0 +1,144 @@
+#include "Hunter.hpp"
+
+//
+// Order assignment by the owners
+//
+// Every order is owned by the Hunter chosen by rendezvous hashing of
+// (customer, Lamport) over the Hunters, so it is served without a contest.
+// A Hunter out of its own orders steals from the owner of a recently seen
+// order: the owner gives away its oldest order which is not being served,
+// so every order is still served exactly once.
+//
+
+// Mix the bits of a 64-bit value (the splitmix64 finalizer)
+static uint64_t mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// Return the owner of the order (rendezvous hashing)
+int64_t Hunter::orderOwner(const Order& order) const {
+    uint64_t key = mix(mix(order.customer) + order.lamport);
+
+    int64_t owner = config.hunterMin;
+    uint64_t ownerWeight = 0;
+    for(int64_t hunter = config.hunterMin; hunter <= config.hunterMax; hunter++) {
+        uint64_t weight = mix(key + hunter);
+        if(hunter == config.hunterMin || weight > ownerWeight) {
+            owner = hunter;
+            ownerWeight = weight;
+        }
+    }
+    return owner;
+}
+
+// Add an order received from a Customer (the owner assignment, requires `stateMutex`)
+void Hunter::addOwnedOrder(const Order& order) {
+    int64_t owner = orderOwner(order);
+
+    if(owner == id) {
+        orders.push_back(order);
+        logger.debug() << "Received " << order << " - owning it\n";
+    } else {
+        // The owner may have more orders than it can serve
+        if(find(stealVictims.begin(), stealVictims.end(), owner) == stealVictims.end()) {
+            stealVictims.push_back(owner);
+        }
+        logger.debug() << "Received " << order << " - owned by " << owner << "\n";
+    }
+
+    // Notify the waiting thread
+    if(state == HunterState::Waiting) {
+        waitingForNewOrderWait.notify_one();
+    }
+}
+
+// Serve own orders, or steal one from another Hunter
+size_t Hunter::acquireOrderByOwner(unique_lock<mutex>& lock) {
+    if(!orders.empty()) {
+        logger() << "Serving own " << orders.front() << "\n";
+        return min(missionOrders(), orders.size());
+    }
+
+    int64_t victim = stealVictims.front();
+    stealVictims.pop_front();
+    stealingReplied = false;
+    stealingStole = false;
+
+    logger() << "Trying to steal an order from " << victim << "\n";
+
+    incrementLamport();
+    OrderSteal steal { getLamport(), clock.now() };
+    messenger->send(steal, victim, Tag::OrderSteal);
+    countSent(Tag::OrderSteal);
+
+    // Wait for the reply
+    await(stealingWait, lock, [this] { return stealingReplied; });
+
+    metrics.contest(!stealingStole);
+
+    if(!stealingStole) {
+        logger() << "Nothing to steal from " << victim << "\n";
+        return 0;
+    }
+
+    // The stolen order goes with the own ones which have arrived meanwhile
+    return min(missionOrders(), orders.size());
+}
+
+// Handle the `OrderSteal` message
+void Hunter::handleOrderSteal() {
+    OrderSteal steal;
+    messenger->take(steal);
+    incrementLamport(steal.lamport);
+    clock.merge(steal.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        // The first orders are being served after they have been got (or the first one stolen)
+        size_t first = servingOrders;
+        if(state == HunterState::GettingOrder && stealingReplied && stealingStole) {
+            first = 1;
+        }
+
+        incrementLamport();
+        OrderStealReply reply { 0, 0, 0, getLamport(), clock.now() };
+
+        if(const Order* given = orders.at(first)) {
+            Order order = *given;
+            reply.orderCustomer = order.customer;
+            reply.orderLamport = order.lamport;
+            reply.stolen = 1;
+            logger.debug() << "Giving away " << order << " to " << status.MPI_SOURCE << "\n";
+            orders.erase(order);
+        } else {
+            logger.debug() << "Nothing to give away to " << status.MPI_SOURCE << "\n";
+        }
+
+        messenger->send(reply, status.MPI_SOURCE, Tag::OrderStealReply);
+        countSent(Tag::OrderStealReply);
+    }
+}
+
+// Handle the `OrderStealReply` message
+void Hunter::handleOrderStealReply() {
+    OrderStealReply reply;
+    messenger->take(reply);
+    incrementLamport(reply.lamport);
+    clock.merge(reply.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        if(reply.stolen) {
+            orders.push_front(Order(reply.orderCustomer, reply.orderLamport));
+            logger() << "Stole " << orders.front() << " from " << status.MPI_SOURCE << "\n";
+        }
+
+        stealingReplied = true;
+        stealingStole = reply.stolen != 0;
+        stealingWait.notify_one();
+    }
+}
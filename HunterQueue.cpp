@@ -0,0 +1,50 @@
+#include "Hunter.hpp"
+
+//
+// Order assignment by the global queue
+//
+// The Customers append their orders to a ring in a window of the first
+// Hunter (see `OrderRing`) instead of sending them, and an idle Hunter
+// claims the oldest one with a compare-and-swap of the head. An order is
+// claimed by exactly one Hunter, so there is no contest and no list of
+// rejected orders - the only message per order is its completion. An idle
+// Hunter polls the queue with an exponential backoff.
+//
+
+// The longest pause between the polls of an empty queue (in microseconds)
+static const uint64_t QueuePollMax = 256;
+
+// Wait until an order is claimed from the global queue or terminated (requires `stateMutex`)
+void Hunter::waitForQueuedOrder(unique_lock<mutex>& lock) {
+    uint64_t pause = 1;
+    while(!terminated && !claimQueuedOrder()) {
+        // An empty queue may be the last thing keeping the Hunter active
+        passToken();
+
+        foregroundWaits([] { return false; });
+        waitingForNewOrderWait.wait_for(lock, chrono::microseconds(pause));
+        foregroundWaits(nullptr);
+        pause = min(2 * pause, QueuePollMax);
+    }
+}
+
+// Claim the next order from the global queue, if any (requires `stateMutex`)
+bool Hunter::claimQueuedOrder() {
+    Order order;
+    if(!orderRing->pop(order)) return false;
+
+    // Placing the order happened before
+    incrementLamport(order.lamport);
+    clock.merge(order.time);
+    receivedOrders[order.customer] += 1;
+
+    orders.push_back(order);
+    logger.debug() << "Claimed " << order << " from the queue\n";
+    return true;
+}
+
+// The claimed order is the Hunter's own - along with any more to fill a mission
+size_t Hunter::acquireOrderByQueue(unique_lock<mutex>& lock) {
+    while(orders.size() < missionOrders() && claimQueuedOrder()) { }
+    return orders.size();
+}
@@ -0,0 +1,209 @@
+#include "Hunter.hpp"
+
+#include <cmath>
+
+//
+// Store admission by a quorum of the Hunters
+//
+// The Hunters are split into `shopSize` groups and at most one Hunter of
+// a group can be in the store. Within a group the Hunters run Maekawa's
+// algorithm: every Hunter is an arbiter locked for at most one request,
+// and a Hunter enters the store after it has locked all the arbiters of
+// its quorum - a row and a column of the group arranged in a grid, so an
+// entry costs O(sqrt(N)) messages. `QuorumFailed`, `QuorumInquire` and
+// `QuorumRelinquish` let a request with a higher priority (lower Lamport
+// value, then lower identifier) take over a lock and avoid deadlocks.
+//
+
+// Build the grid quorum of the Hunter
+void Hunter::buildQuorum() {
+    int64_t groups = max<int64_t>(config.shopSize, 1);
+
+    vector<int64_t> group;
+    for(int64_t hunter = config.hunterMin; hunter <= config.hunterMax; hunter++) {
+        if((hunter - config.hunterMin) % groups == (id - config.hunterMin) % groups) {
+            group.push_back(hunter);
+        }
+    }
+
+    // The quorum is the row and the column of the Hunter in a grid of the group,
+    // so two quorums meet where the row of one crosses the column of the other
+    // (with the last row not full, at least one of the two crossings is in a full row)
+    int64_t size = group.size();
+    int64_t columns = static_cast<int64_t>(ceil(sqrt(static_cast<double>(size))));
+    int64_t position = find(group.begin(), group.end(), id) - group.begin();
+
+    quorum.clear();
+    for(int64_t i = 0; i < size; i++) {
+        if(i / columns == position / columns || i % columns == position % columns) {
+            quorum.push_back(group[i]);
+        }
+    }
+}
+
+// Lock all the arbiters of the quorum
+void Hunter::acquireStoreByQuorum(unique_lock<mutex>& lock) {
+    quorumRequestLamport = getLamport();
+    quorumLocked.clear();
+    quorumFailed = false;
+    quorumInquiries.clear();
+
+    for(int64_t hunter: quorum) {
+        sendQuorum(hunter, Tag::QuorumRequest, quorumRequestLamport);
+    }
+    logger.debug() << "Store request sent to the quorum of " << quorum.size() << ", waiting...\n";
+
+    await(quorumWait, lock, [this] { return quorumLocked.size() == quorum.size(); });
+}
+
+// Release all the arbiters of the quorum
+void Hunter::releaseStoreByQuorum() {
+    uint64_t requestLamport = quorumRequestLamport;
+    quorumRequestLamport = 0;
+    quorumLocked.clear();
+    quorumInquiries.clear();
+
+    for(int64_t hunter: quorum) {
+        sendQuorum(hunter, Tag::QuorumRelease, requestLamport);
+    }
+}
+
+// Send a quorum message, handling messages to itself in place (requires `stateMutex`)
+void Hunter::sendQuorum(int64_t hunter, int tag, uint64_t requestLamport) {
+    if(hunter == id) {
+        onQuorumMessage(id, tag, requestLamport);
+        return;
+    }
+
+    incrementLamport();
+    QuorumMessage message { requestLamport, getLamport(), clock.now() };
+    messenger->send(message, hunter, tag);
+    countSent(tag);
+}
+
+// Give the lock back to the arbiter (requires `stateMutex`)
+void Hunter::relinquishQuorum(int64_t arbiter) {
+    logger.debug() << "Giving the lock back to " << arbiter << "\n";
+    quorumLocked.erase(arbiter);
+    sendQuorum(arbiter, Tag::QuorumRelinquish, quorumRequestLamport);
+}
+
+// Lock the arbiter for the next waiting request (requires `stateMutex`)
+void Hunter::lockArbiter() {
+    arbiterInquired = false;
+    if(arbiterQueue.empty()) {
+        arbiterLock = { 0, -1 };
+        return;
+    }
+    arbiterLock = *arbiterQueue.begin();
+    arbiterQueue.erase(arbiterQueue.begin());
+    sendQuorum(arbiterLock.second, Tag::QuorumLocked, arbiterLock.first);
+}
+
+// Handle a quorum message (requires `stateMutex`)
+void Hunter::onQuorumMessage(int64_t hunter, int tag, uint64_t requestLamport) {
+    pair<uint64_t, int64_t> request { requestLamport, hunter };
+    bool current = requestLamport == quorumRequestLamport && quorumRequestLamport != 0;
+
+    switch(tag) {
+
+    // Arbiter
+
+    case Tag::QuorumRequest:
+        if(arbiterLock.second == -1) {
+            arbiterLock = request;
+            sendQuorum(hunter, Tag::QuorumLocked, requestLamport);
+        } else {
+            arbiterQueue.insert(request);
+            if(request < arbiterLock && request == *arbiterQueue.begin()) {
+                // The request goes first - the previous first one fails here
+                if(arbiterQueue.size() > 1) {
+                    auto previous = *next(arbiterQueue.begin());
+                    sendQuorum(previous.second, Tag::QuorumFailed, previous.first);
+                }
+                if(!arbiterInquired) {
+                    arbiterInquired = true;
+                    sendQuorum(arbiterLock.second, Tag::QuorumInquire, arbiterLock.first);
+                }
+            } else {
+                sendQuorum(hunter, Tag::QuorumFailed, requestLamport);
+            }
+        }
+        break;
+
+    case Tag::QuorumRelinquish:
+        if(arbiterLock == request) {
+            arbiterQueue.insert(arbiterLock);
+            lockArbiter();
+        }
+        break;
+
+    case Tag::QuorumRelease:
+        if(arbiterLock == request) {
+            lockArbiter();
+        } else {
+            arbiterQueue.erase(request);
+        }
+        break;
+
+    // Requester
+
+    case Tag::QuorumLocked:
+        if(!current) break;
+        quorumLocked.insert(hunter);
+        if(quorumLocked.size() == quorum.size()) {
+            logger() << "Can get into the store\n";
+            quorumInquiries.clear();
+            quorumWait.notify_one();
+        } else if(quorumFailed && quorumInquiries.erase(hunter) != 0) {
+            // The inquiry has overtaken the lock
+            relinquishQuorum(hunter);
+        }
+        break;
+
+    case Tag::QuorumFailed:
+        if(!current) break;
+        quorumFailed = true;
+        {
+            // Relinquishing to itself may change the inquiries
+            set<int64_t> inquiries;
+            swap(inquiries, quorumInquiries);
+            for(int64_t arbiter: inquiries) {
+                if(quorumLocked.count(arbiter) != 0) {
+                    relinquishQuorum(arbiter);
+                } else {
+                    quorumInquiries.insert(arbiter);
+                }
+            }
+        }
+        break;
+
+    case Tag::QuorumInquire:
+        // Ignore if already in the store
+        if(!current || quorumLocked.size() == quorum.size()) break;
+        if(quorumFailed && quorumLocked.count(hunter) != 0) {
+            relinquishQuorum(hunter);
+        } else {
+            // Wait for a failure (or for the lock, if the inquiry came first)
+            quorumInquiries.insert(hunter);
+        }
+        break;
+    }
+}
+
+// Handle the `Quorum*` messages
+void Hunter::handleQuorumMessage() {
+    QuorumMessage message;
+    messenger->take(message);
+    incrementLamport(message.lamport);
+    clock.merge(message.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        logger.debug() << "Received " << Tag::name(status.MPI_TAG) << "(requestLamport = "
+            << message.requestLamport << ") from " << status.MPI_SOURCE << "\n";
+
+        onQuorumMessage(status.MPI_SOURCE, status.MPI_TAG, message.requestLamport);
+    }
+}
@@ -0,0 +1,71 @@
+#include "Hunter.hpp"
+
+//
+// Order selection (the contest assignment)
+//
+// Every Hunter sees the same pending orders, so when all the idle Hunters
+// go after the oldest one, all but one of them lose a whole round of
+// requests. The other policies spread the idle Hunters over the oldest
+// `selectionWidth` groups of orders instead. The selection only decides
+// which group a Hunter contests - who gets it is still decided by the
+// contest, so every policy is safe, only the lost contests differ.
+//
+
+// Choose the group of pending orders to contest into `gettingOrders` (requires `stateMutex`)
+void Hunter::selectOrders() {
+    size_t width = config.orderSelection == OrderSelection::Front ? 1 : max<size_t>(config.selectionWidth, 1);
+
+    // Positions of the first orders of the oldest groups
+    vector<size_t> groups;
+    for(size_t i = 0; i < orders.size() && groups.size() < width; ) {
+        groups.push_back(i);
+        const Order& first = *orders.at(i);
+        for(i++; i < orders.size() && sameGroup(first, *orders.at(i)); i++) { }
+    }
+
+    size_t chosen = 0;
+    switch(config.orderSelection) {
+    case OrderSelection::Front:
+        break;
+    case OrderSelection::Stride:
+        chosen = (id - config.hunterMin) % groups.size();
+        break;
+    case OrderSelection::Random:
+        chosen = uniform_int_distribution<size_t>(0, groups.size() - 1)(selectionRandom);
+        break;
+    case OrderSelection::Choices:
+        if(groups.size() > 1) {
+            // Two different groups - the older one if the Hunter is likely to win a conflict over it
+            uniform_int_distribution<size_t> random(0, groups.size() - 1);
+            size_t older = random(selectionRandom);
+            size_t newer = random(selectionRandom);
+            while(newer == older) {
+                newer = random(selectionRandom);
+            }
+            if(older > newer) swap(older, newer);
+
+            int64_t hunters = config.hunterMax - config.hunterMin + 1;
+            chosen = 2 * priorityRank() < hunters ? older : newer;
+        }
+        break;
+    }
+
+    const Order first = *orders.at(groups[chosen]);
+    gettingOrders.assign(1, first);
+    for(size_t i = groups[chosen] + 1; i < orders.size() && sameGroup(first, *orders.at(i)); i++) {
+        gettingOrders.push_back(*orders.at(i));
+    }
+}
+
+// Number of the other Hunters which would win a contest with this one, as last known
+int64_t Hunter::priorityRank() const {
+    int64_t rank = 0;
+    for(int64_t hunter = config.hunterMin; hunter <= config.hunterMax; hunter++) {
+        if(hunter == id) continue;
+        if(hunterLastOrders[hunter] < lastOrderLamport ||
+            (hunterLastOrders[hunter] == lastOrderLamport && hunter < id)) {
+            rank += 1;
+        }
+    }
+    return rank;
+}
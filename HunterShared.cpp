@@ -0,0 +1,40 @@
+#include "Hunter.hpp"
+
+//
+// Store admission by a semaphore in shared memory
+//
+// The Hunters draw tickets and count exits with one-sided atomics on a
+// window of the first Hunter (see `StoreSemaphore`), so an entry costs no
+// messages at all. A Hunter not admitted right away polls the window with
+// an exponential backoff, leaving `stateMutex` to the messaging thread.
+//
+
+// The longest pause between the polls of the semaphore (in microseconds)
+static const uint64_t SharedPollMax = 256;
+
+// Take a ticket and wait until it is admitted
+void Hunter::acquireStoreByShared(unique_lock<mutex>& lock) {
+    if(!storeSemaphore->enter()) {
+        logger.debug() << "Store semaphore taken, waiting...\n";
+
+        foregroundWaits([] { return false; });
+        lock.unlock();
+        uint64_t pause = 1;
+        do {
+            this_thread::sleep_for(chrono::microseconds(pause));
+            pause = min(2 * pause, SharedPollMax);
+        } while(!storeSemaphore->admitted());
+        lock.lock();
+        foregroundWaits(nullptr);
+    }
+
+    // The exit which let us in happened before
+    incrementLamport(storeSemaphore->exitLamport);
+    clock.merge(storeSemaphore->exitTime);
+    logger() << "Can get into the store\n";
+}
+
+// Count the exit, letting the next ticket in
+void Hunter::releaseStoreByShared() {
+    storeSemaphore->leave(getLamport(), clock.now());
+}
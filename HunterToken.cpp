@@ -0,0 +1,150 @@
+#include "Hunter.hpp"
+
+//
+// Store admission by the store tokens
+//
+// `shopSize` tokens circulate between the Hunters and only a Hunter holding
+// a token can be in the store. The first Hunter manages the tokens - it hands
+// them out in turn and tells the last assignee of a token where to pass it
+// after use. A token kept from the previous visit lets the Hunter into the
+// store without any messages, otherwise the entry costs at most three
+// messages (request, forward and the token itself).
+//
+
+// Wait for a store token
+void Hunter::acquireStoreByToken(unique_lock<mutex>& lock) {
+
+    // A kept token is always free - tokens promised to others are passed on right away
+    if(!storeTokens.empty()) {
+        storeTokenUsed = *storeTokens.begin();
+        logger() << "Using the kept store token " << storeTokenUsed << "\n";
+        return;
+    }
+
+    // Ask the manager for a token
+    if(id == config.hunterMin) {
+        assignStoreToken(id);
+    } else {
+        incrementLamport();
+        StoreTokenRequest request { getLamport(), clock.now() };
+        messenger->send(request, config.hunterMin, Tag::StoreTokenRequest);
+        countSent(Tag::StoreTokenRequest);
+    }
+    logger() << "Store token requested, waiting...\n";
+
+    // Wait for the token
+    await(storeTokenWait, lock, [this] { return storeTokenUsed != -1; });
+}
+
+// Pass the used store token on or keep it for the next visit
+void Hunter::releaseStoreByToken() {
+    int64_t token = storeTokenUsed;
+    storeTokenUsed = -1;
+
+    if(auto it = storeTokenNext.find(token); it != storeTokenNext.end()) {
+        int64_t hunter = it->second;
+        storeTokenNext.erase(it);
+        sendStoreToken(token, hunter);
+    } else {
+        logger() << "Keeping the store token " << token << "\n";
+    }
+}
+
+// Assign the next store token to the Hunter (the token manager only, requires `stateMutex`)
+void Hunter::assignStoreToken(int64_t hunter) {
+    int64_t token = storeTokenQueue.front();
+    storeTokenQueue.pop_front();
+    storeTokenQueue.push_back(token);
+
+    int64_t previous = storeTokenAssignee[token];
+    storeTokenAssignee[token] = hunter;
+
+    logger.debug() << "Assigning the store token " << token << " to " << hunter
+        << " after " << previous << "\n";
+
+    if(previous == id) {
+        forwardStoreToken(token, hunter);
+    } else {
+        incrementLamport();
+        StoreTokenForward forward { token, hunter, getLamport(), clock.now() };
+        messenger->send(forward, previous, Tag::StoreTokenForward);
+        countSent(Tag::StoreTokenForward);
+    }
+}
+
+// Pass the store token to the given Hunter after it is used (requires `stateMutex`)
+void Hunter::forwardStoreToken(int64_t token, int64_t hunter) {
+    if(storeTokens.count(token) != 0 && storeTokenUsed != token) {
+        sendStoreToken(token, hunter);
+    } else {
+        // The token is in use or still on its way here
+        storeTokenNext[token] = hunter;
+    }
+}
+
+// Send the store token to the given Hunter (requires `stateMutex`)
+void Hunter::sendStoreToken(int64_t token, int64_t hunter) {
+    storeTokens.erase(token);
+
+    logger.debug() << "Passing the store token " << token << " to " << hunter << "\n";
+
+    incrementLamport();
+    StoreToken message { token, getLamport(), clock.now() };
+    messenger->send(message, hunter, Tag::StoreToken);
+    countSent(Tag::StoreToken);
+}
+
+// Handle the `StoreTokenRequest` message
+void Hunter::handleStoreTokenRequest() {
+    StoreTokenRequest request;
+    messenger->take(request);
+    incrementLamport(request.lamport);
+    clock.merge(request.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        logger.debug() << "Received a store token request from " << status.MPI_SOURCE << "\n";
+        assignStoreToken(status.MPI_SOURCE);
+    }
+}
+
+// Handle the `StoreTokenForward` message
+void Hunter::handleStoreTokenForward() {
+    StoreTokenForward forward;
+    messenger->take(forward);
+    incrementLamport(forward.lamport);
+    clock.merge(forward.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        logger.debug() << "The store token " << forward.token << " goes to " << forward.hunter << " next\n";
+        forwardStoreToken(forward.token, forward.hunter);
+    }
+}
+
+// Handle the `StoreToken` message
+void Hunter::handleStoreToken() {
+    StoreToken message;
+    messenger->take(message);
+    incrementLamport(message.lamport);
+    clock.merge(message.time);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        logger.debug() << "Received the store token " << message.token << " from " << status.MPI_SOURCE << "\n";
+
+        storeTokens.insert(message.token);
+        if(state == HunterState::GettingStore && storeTokenUsed == -1) {
+            storeTokenUsed = message.token;
+            logger() << "Can get into the store\n";
+            storeTokenWait.notify_one();
+        } else if(auto it = storeTokenNext.find(message.token); it != storeTokenNext.end()) {
+            int64_t hunter = it->second;
+            storeTokenNext.erase(it);
+            sendStoreToken(message.token, hunter);
+        }
+    }
+}
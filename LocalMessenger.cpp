@@ -0,0 +1,77 @@
+#include "LocalMessenger.hpp"
+
+LocalTransport::LocalTransport(const Config& config) :
+    mailboxes(config.hunterMax + 1),
+    hunterMin(config.hunterMin),
+    hunterMax(config.hunterMax)
+    { }
+
+unique_ptr<Messenger> LocalTransport::connect(int64_t id) {
+    return make_unique<LocalMessenger>(*this, id);
+}
+
+LocalMessenger::LocalMessenger(LocalTransport& transport, int64_t id) :
+    transport(transport),
+    id(id)
+    { }
+
+LocalMessenger::~LocalMessenger() {
+    delete current;
+}
+
+// Start a send of the encoded message
+void LocalMessenger::sendBytes(const char* message, size_t size, int destination, int tag) {
+    LocalMessage* local = new LocalMessage();
+    local->source = id;
+    local->tag = tag;
+    local->size = size;
+    memcpy(local->data, message, size);
+    transport.mailboxes[destination].push(local);
+}
+
+// Send the encoded message to all the Hunters but this agent
+void LocalMessenger::broadcastBytes(const char* message, size_t size, int tag) {
+    for(int64_t hunter = transport.hunterMin; hunter <= transport.hunterMax; hunter++) {
+        if(hunter != id) {
+            sendBytes(message, size, hunter, tag);
+        }
+    }
+}
+
+// The broadcast is a message to every Hunter, this one included
+void LocalMessenger::sendCollectiveBytes(const char* message, size_t size, int tag) {
+    for(int64_t hunter = transport.hunterMin; hunter <= transport.hunterMax; hunter++) {
+        sendBytes(message, size, hunter, tag);
+    }
+}
+
+// Nothing to post - the collective broadcast arrives in the mailbox
+void LocalMessenger::expectCollective(int tag) { }
+
+// Encoded message returned by the last `receiveMessage` or `pollMessage`
+const char* LocalMessenger::currentMessage(size_t& size) const {
+    size = current->size;
+    return current->data;
+}
+
+// Make the message the current one
+void LocalMessenger::next(LocalMessage* message, MPI_Status& status) {
+    delete current;
+    current = message;
+    status.MPI_SOURCE = message->source;
+    status.MPI_TAG = message->tag;
+    status.MPI_ERROR = MPI_SUCCESS;
+}
+
+// Wait for the next message and return its status (source and tag)
+void LocalMessenger::receiveMessage(MPI_Status& status) {
+    next(transport.mailboxes[id].wait(), status);
+}
+
+// Return the status of the next message if one has arrived, without waiting
+bool LocalMessenger::pollMessage(MPI_Status& status) {
+    LocalMessage* message = transport.mailboxes[id].pop();
+    if(message == nullptr) return false;
+    next(message, status);
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef LOCAL_MESSENGER_HPP
+#define LOCAL_MESSENGER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <mpi.h>
+
+#include "Config.hpp"
+#include "Mailbox.hpp"
+#include "Message.hpp"
+#include "Messenger.hpp"
+
+using namespace std;
+
+// A message between the agents of one process
+struct LocalMessage {
+    atomic<LocalMessage*> next { nullptr };
+    int source = 0;
+    int tag = 0;
+    size_t size = 0;
+    char data[Messenger::BufferSize];
+};
+
+// Transport within a single process - every agent is a thread with a mailbox
+class LocalTransport : public Transport {
+private:
+
+    // Mailboxes of the agents by their identifiers
+    deque<Mailbox<LocalMessage>> mailboxes;
+
+    // Identifiers of the Hunters
+    const int64_t hunterMin;
+    const int64_t hunterMax;
+
+    friend class LocalMessenger;
+
+public:
+
+    LocalTransport(const Config& config);
+
+    unique_ptr<Messenger> connect(int64_t id) override;
+};
+
+// Messenger of an agent of the local transport
+class LocalMessenger : public Messenger {
+private:
+
+    LocalTransport& transport;
+
+    // Identifier of the agent
+    const int64_t id;
+
+    // The message being handled
+    LocalMessage* current = nullptr;
+
+    // Make the message the current one
+    void next(LocalMessage* message, MPI_Status& status);
+
+protected:
+
+    void sendBytes(const char* message, size_t size, int destination, int tag) override;
+    void broadcastBytes(const char* message, size_t size, int tag) override;
+    void sendCollectiveBytes(const char* message, size_t size, int tag) override;
+    void receiveMessage(MPI_Status& status) override;
+    bool pollMessage(MPI_Status& status) override;
+    const char* currentMessage(size_t& size) const override;
+
+public:
+
+    LocalMessenger(LocalTransport& transport, int64_t id);
+
+    ~LocalMessenger();
+
+    void expectCollective(int tag) override;
+};
+
+#endif
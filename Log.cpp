@@ -0,0 +1,241 @@
+#include "Log.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+// Number of 64-bit values stored for an item of the given kind
+int logItemValues(LogItem kind) {
+    switch(kind) {
+    case LogItem::Text:             return 1;
+    case LogItem::Signed:           return 1;
+    case LogItem::Unsigned:         return 1;
+    case LogItem::Order:            return 2;
+    case LogItem::OrderCompletion:  return 2;
+    case LogItem::OrderRequest:     return 4;
+    case LogItem::OrderRequestAck:  return 2;
+    case LogItem::Token:            return 2;
+    case LogItem::StoreRequest:     return 1;
+    case LogItem::StoreRequestAck:  return 1;
+    }
+    return 0;
+}
+
+// Print a record as a text line, resolving the texts with `text`
+void formatRecord(
+    ostream& stream,
+    const string& type,
+    int64_t id,
+    const LogRecord& record,
+    const function<const char*(uint64_t)>& text) {
+
+    stream
+        << type
+        << " [" << setfill('0') << setw(2) << id << "] "
+        << setfill('0') << setw(5) << record.lamport << ": ";
+
+    const uint64_t* values = record.data;
+    for(int i = 0; i < record.items; i++) {
+        const uint64_t* v = values;
+        values += logItemValues(record.kinds[i]);
+
+        switch(record.kinds[i]) {
+        case LogItem::Text:
+            stream << text(v[0]);
+            break;
+        case LogItem::Signed:
+            stream << static_cast<int64_t>(v[0]);
+            break;
+        case LogItem::Unsigned:
+            stream << v[0];
+            break;
+        case LogItem::Order:
+            stream << "Order(customer = " << static_cast<int64_t>(v[0]) <<
+                ", orderLamport = " << v[1] << ")";
+            break;
+        case LogItem::OrderCompletion:
+            stream << "OrderCompletion(customer = " << static_cast<int64_t>(v[0]) <<
+                ", orderLamport = " << v[1] << ")";
+            break;
+        case LogItem::OrderRequest:
+            stream << "OrderRequest(customer = "
+                << static_cast<int64_t>(v[0]) << ", orderLamport = " << v[1]
+                << ", orders = " << v[2] << ", lastOrder = " << v[3] << ")";
+            break;
+        case LogItem::OrderRequestAck:
+            stream << "OrderRequestAck(customer = "
+                << static_cast<int64_t>(v[0]) << ", orderLamport = "
+                << v[1] << ")";
+            break;
+        case LogItem::Token:
+            stream << "Token(count = " << static_cast<int64_t>(v[0])
+                << ", black = " << (v[1] ? "true" : "false") << ")";
+            break;
+        case LogItem::StoreRequest:
+            stream << "StoreRequest(lamport = " << v[0] << ")";
+            break;
+        case LogItem::StoreRequestAck:
+            stream << "StoreRequestAck(requestLamport = "
+                << v[0] << ")";
+            break;
+        }
+    }
+}
+
+//
+// Ring buffer
+//
+
+LogRing::LogRing() : slots(new Slot[Capacity]) {
+    for(uint64_t i = 0; i < Capacity; i++) {
+        slots[i].sequence.store(i, memory_order_relaxed);
+    }
+}
+
+// Add a record, waiting for the consumer while the ring is full
+void LogRing::push(const LogRecord& record) {
+    uint64_t position = head.load(memory_order_relaxed);
+    Slot* slot;
+    while(true) {
+        slot = &slots[position % Capacity];
+        uint64_t sequence = slot->sequence.load(memory_order_acquire);
+        int64_t difference = static_cast<int64_t>(sequence - position);
+
+        if(difference == 0) {
+            // The slot is free - claim it
+            if(head.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+        } else if(difference < 0) {
+            // The ring is full
+            this_thread::yield();
+            position = head.load(memory_order_relaxed);
+        } else {
+            // Another producer has claimed the slot
+            position = head.load(memory_order_relaxed);
+        }
+    }
+
+    slot->record = record;
+    slot->sequence.store(position + 1, memory_order_release);
+}
+
+// Take the oldest record, if any
+bool LogRing::pop(LogRecord& record) {
+    Slot& slot = slots[tail % Capacity];
+    if(slot.sequence.load(memory_order_acquire) != tail + 1) {
+        return false;
+    }
+
+    record = slot.record;
+    slot.sequence.store(tail + Capacity, memory_order_release);
+    tail += 1;
+    return true;
+}
+
+//
+// Sink
+//
+
+// Write a value in binary form
+template<typename T>
+static void writeValue(ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+LogSink::LogSink(const string& fileName, int64_t rank) {
+    if(!fileName.empty()) {
+        file.open(fileName + "." + to_string(rank), ios::binary);
+        file.write(LogFile::Magic, sizeof(LogFile::Magic));
+    }
+
+    flusher = thread([this] {
+        while(!stopping.load()) {
+            flush();
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        flush();
+    });
+}
+
+LogSink::~LogSink() {
+    stopping = true;
+    flusher.join();
+}
+
+// Add an agent, returning the source of its records
+uint32_t LogSink::attach(int64_t id, const string& type) {
+    lock_guard<mutex> lock(agentsMutex);
+    agents.push_back({ id, type });
+    return agents.size() - 1;
+}
+
+// The agent which logged the record
+const LogSink::Agent& LogSink::agent(const LogRecord& record) {
+    if(record.source >= known.size()) {
+        lock_guard<mutex> lock(agentsMutex);
+        for(size_t source = known.size(); source < agents.size(); source++) {
+            const Agent& added = known.emplace_back(agents[source]);
+            if(file.is_open()) {
+                writeValue(file, LogFile::Agent);
+                writeValue(file, added.id);
+                writeValue(file, static_cast<uint8_t>(added.type.size()));
+                file.write(added.type.data(), added.type.size());
+            }
+        }
+    }
+    return known[record.source];
+}
+
+// Write out all the queued records
+void LogSink::flush() {
+    LogRecord record;
+    bool written = false;
+    while(ring.pop(record)) {
+        written = true;
+        const Agent& logged = agent(record);
+        if(file.is_open()) {
+            writeBinary(record);
+        } else {
+            formatRecord(cout, logged.type, logged.id, record, [](uint64_t text) {
+                return reinterpret_cast<const char*>(text);
+            });
+        }
+    }
+    if(written) {
+        if(file.is_open()) {
+            file.flush();
+        } else {
+            cout.flush();
+        }
+    }
+}
+
+// Write a record in binary form
+void LogSink::writeBinary(const LogRecord& record) {
+    LogRecord written = record;
+
+    // Replace the texts with their identifiers, defining the new ones
+    uint64_t* values = written.data;
+    for(int i = 0; i < written.items; i++) {
+        if(written.kinds[i] == LogItem::Text) {
+            auto [it, added] = texts.emplace(values[0], texts.size());
+            if(added) {
+                const char* text = reinterpret_cast<const char*>(values[0]);
+                uint32_t length = char_traits<char>::length(text);
+                writeValue(file, LogFile::Text);
+                writeValue(file, it->second);
+                writeValue(file, length);
+                file.write(text, length);
+            }
+            values[0] = it->second;
+        }
+        values += logItemValues(written.kinds[i]);
+    }
+
+    writeValue(file, LogFile::Record);
+    writeValue(file, written.source);
+    writeValue(file, written.lamport);
+    writeValue(file, written.items);
+    file.write(reinterpret_cast<const char*>(written.kinds), written.items);
+    writeValue(file, written.values);
+    file.write(reinterpret_cast<const char*>(written.data), written.values * sizeof(uint64_t));
+}
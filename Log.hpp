@@ -0,0 +1,176 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Message.hpp"
+
+using namespace std;
+
+// Log levels - lines below `LOG_LEVEL` are removed at compile time
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_OFF 2
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Kind of a value written to a log line
+enum class LogItem : uint8_t {
+    Text,               // string literal
+    Signed,
+    Unsigned,
+    Order,
+    OrderCompletion,
+    OrderRequest,
+    OrderRequestAck,
+    Token,
+    StoreRequest,
+    StoreRequestAck
+};
+
+// Number of 64-bit values stored for an item of the given kind
+int logItemValues(LogItem kind);
+
+// A single log line, stored in binary form until it is written out
+struct LogRecord {
+
+    static const int MaxItems = 16;
+    static const int MaxValues = 32;
+
+    // Agent which logged the line (its number in the sink)
+    uint32_t source = 0;
+
+    // Lamport value of the agent when logging
+    uint64_t lamport = 0;
+
+    // Items of the line and their values
+    uint8_t items = 0;
+    uint8_t values = 0;
+    LogItem kinds[MaxItems];
+    uint64_t data[MaxValues];
+
+    // Append an item (ignored if the record is full)
+    void add(LogItem kind, initializer_list<uint64_t> itemValues) {
+        if(items == MaxItems || values + itemValues.size() > MaxValues) return;
+        kinds[items++] = kind;
+        for(uint64_t value: itemValues) {
+            data[values++] = value;
+        }
+    }
+};
+
+// Print a record as a text line, resolving the texts with `text`
+void formatRecord(
+    ostream& stream,
+    const string& type,
+    int64_t id,
+    const LogRecord& record,
+    const function<const char*(uint64_t)>& text);
+
+// Bounded lock-free queue of the records (Vyukov's ring buffer).
+// Any thread may push, a single thread pops.
+class LogRing {
+private:
+
+    struct Slot {
+        atomic<uint64_t> sequence;
+        LogRecord record;
+    };
+
+    static const uint64_t Capacity = 4096;
+
+    unique_ptr<Slot[]> slots;
+
+    // Next position to push (producers) and to pop (consumer)
+    alignas(64) atomic<uint64_t> head { 0 };
+    alignas(64) uint64_t tail = 0;
+
+public:
+
+    LogRing();
+
+    // Add a record, waiting for the consumer while the ring is full
+    void push(const LogRecord& record);
+
+    // Take the oldest record, if any
+    bool pop(LogRecord& record);
+};
+
+// Log of a process, shared by all its agents - the records are written out
+// by a background thread: as text to the standard output, or in binary form
+// to a file (see LogFormat.cpp).
+class LogSink {
+private:
+
+    struct Agent {
+        int64_t id;
+        string type;
+    };
+
+    LogRing ring;
+
+    // Agents logging to the sink, numbered in the order they attach - the
+    // flusher copies the new ones (writing them out) when it meets them
+    mutex agentsMutex;
+    vector<Agent> agents;
+    vector<Agent> known;
+
+    // Binary output (text to the standard output if not open)
+    ofstream file;
+
+    // Identifiers of the texts already written to the binary output
+    unordered_map<uint64_t, uint32_t> texts;
+
+    atomic<bool> stopping { false };
+    thread flusher;
+
+    // Write out all the queued records
+    void flush();
+
+    // The agent which logged the record
+    const Agent& agent(const LogRecord& record);
+
+    // Write a record in binary form
+    void writeBinary(const LogRecord& record);
+
+public:
+
+    // Log as text to the standard output, or in binary form to
+    // `<fileName>.<rank>` if `fileName` is set
+    LogSink(const string& fileName, int64_t rank);
+
+    // Write out the remaining records
+    ~LogSink();
+
+    // Add an agent, returning the source of its records
+    uint32_t attach(int64_t id, const string& type);
+
+    void push(const LogRecord& record) {
+        ring.push(record);
+    }
+};
+
+// Binary log file format
+namespace LogFile {
+    const char Magic[8] = { 'B', 'H', 'L', 'O', 'G', '\0', '\0', '\4' };
+
+    // Entries following the header (an agent before its records)
+    const uint8_t Agent = 'A';
+    const uint8_t Text = 'S';
+    const uint8_t Record = 'R';
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Log.hpp"
+
+using namespace std;
+
+//
+// Offline formatter of the binary logs
+//
+// Usage: ./logformat <logFile>.0 <logFile>.1 ...
+//
+// Prints the lines of all the given logs as text, in the order of their
+// Lamport values (the lines of a single log keep their order).
+//
+
+// Agent of a log
+struct Agent {
+    int64_t id;
+    string type;
+};
+
+// Line of a log, already formatted
+struct Line {
+    uint64_t lamport;
+    string text;
+};
+
+// Read a value in binary form
+template<typename T>
+static bool readValue(ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// Check that the items of a record have as many values as it holds
+static bool validRecord(const LogRecord& record) {
+    int values = 0;
+    for(int i = 0; i < record.items; i++) {
+        if(logItemValues(record.kinds[i]) == 0) return false;
+        values += logItemValues(record.kinds[i]);
+    }
+    return values == record.values;
+}
+
+// Read and format all the lines of a log
+static bool readLog(const string& fileName, vector<Line>& lines) {
+    ifstream file(fileName, ios::binary);
+    if(!file) {
+        cerr << "Cannot open " << fileName << "\n";
+        return false;
+    }
+
+    char magic[sizeof(LogFile::Magic)];
+    if(!file.read(magic, sizeof(magic)) || memcmp(magic, LogFile::Magic, sizeof(magic)) != 0) {
+        cerr << fileName << " is not a log file\n";
+        return false;
+    }
+
+    // A log cut off in the middle of an entry (the process was killed) keeps the lines before
+    auto truncated = [&fileName]() {
+        cerr << fileName << " is truncated\n";
+        return true;
+    };
+
+    vector<Agent> agents;
+    vector<string> texts;
+    uint8_t entry;
+    while(readValue(file, entry)) {
+        if(entry == LogFile::Agent) {
+            Agent& agent = agents.emplace_back();
+            uint8_t typeLength;
+            if(!readValue(file, agent.id) || !readValue(file, typeLength)) return truncated();
+            agent.type.resize(typeLength);
+            if(!file.read(agent.type.data(), typeLength)) return truncated();
+
+        } else if(entry == LogFile::Text) {
+            uint32_t textId, length;
+            if(!readValue(file, textId) || !readValue(file, length)) return truncated();
+            string text(length, ' ');
+            if(!file.read(text.data(), length)) return truncated();
+            if(texts.size() <= textId) texts.resize(textId + 1);
+            texts[textId] = text;
+
+        } else if(entry == LogFile::Record) {
+            // The counts come from the file - check them before reading into the record
+            LogRecord record;
+            if(
+                !readValue(file, record.source) || !readValue(file, record.lamport) ||
+                !readValue(file, record.items)) return truncated();
+            if(record.items > LogRecord::MaxItems) {
+                cerr << fileName << " is corrupted\n";
+                return false;
+            }
+            if(
+                !file.read(reinterpret_cast<char*>(record.kinds), record.items) ||
+                !readValue(file, record.values)) return truncated();
+            if(record.values > LogRecord::MaxValues) {
+                cerr << fileName << " is corrupted\n";
+                return false;
+            }
+            if(!file.read(reinterpret_cast<char*>(record.data), record.values * sizeof(uint64_t))) return truncated();
+            if(record.source >= agents.size() || !validRecord(record)) {
+                cerr << fileName << " is corrupted\n";
+                return false;
+            }
+
+            ostringstream stream;
+            const Agent& agent = agents[record.source];
+            formatRecord(stream, agent.type, agent.id, record, [&texts](uint64_t text) {
+                return text < texts.size() ? texts[text].c_str() : "?";
+            });
+
+            lines.push_back({ record.lamport, stream.str() });
+
+        } else {
+            cerr << fileName << " is corrupted\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    vector<Line> lines;
+    for(int i = 1; i < argc; i++) {
+        if(!readLog(argv[i], lines)) return 1;
+    }
+
+    stable_sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) {
+        return a.lamport < b.lamport;
+    });
+
+    for(const Line& line: lines) {
+        cout << line.text;
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#ifndef MAILBOX_HPP
+#define MAILBOX_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+using namespace std;
+
+// Unbounded lock-free queue of messages (Vyukov's intrusive MPSC queue).
+// Any thread may push, a single thread pops; the popping thread sleeps
+// while the mailbox is empty. A message is any default-constructible type
+// with an `atomic<T*> next` member.
+template<typename T>
+class Mailbox {
+private:
+
+    // Last pushed message (producers) and the oldest one (consumer)
+    alignas(64) atomic<T*> head;
+    alignas(64) T* tail;
+
+    // Placeholder keeping the queue non-empty
+    T stub;
+
+    // The consumer is waiting for a message
+    atomic<bool> sleeping { false };
+    mutex sleepMutex;
+    condition_variable wake;
+
+    // Link a message at the head
+    void link(T* message) {
+        message->next.store(nullptr, memory_order_relaxed);
+        T* previous = head.exchange(message, memory_order_acq_rel);
+        previous->next.store(message, memory_order_release);
+    }
+
+public:
+
+    Mailbox() :
+        head(&stub),
+        tail(&stub)
+        { }
+
+    // Free the messages left
+    ~Mailbox() {
+        while(T* message = pop()) {
+            delete message;
+        }
+    }
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    // Add a message, waking the consumer up if needed
+    void push(T* message) {
+        link(message);
+
+        // Pairs with the fence of `wait` - either the consumer sees the message or we see it sleeping
+        atomic_thread_fence(memory_order_seq_cst);
+        if(sleeping.load(memory_order_relaxed)) {
+            lock_guard<mutex> lock(sleepMutex);
+            wake.notify_one();
+        }
+    }
+
+    // Take the oldest message, if any (may miss one being pushed right now)
+    T* pop() {
+        T* first = tail;
+        T* next = first->next.load(memory_order_acquire);
+
+        // Skip the placeholder
+        if(first == &stub) {
+            if(next == nullptr) return nullptr;
+            tail = next;
+            first = next;
+            next = next->next.load(memory_order_acquire);
+        }
+
+        if(next != nullptr) {
+            tail = next;
+            return first;
+        }
+
+        // The last message can only be taken with the placeholder behind it
+        if(first != head.load(memory_order_acquire)) return nullptr;
+        link(&stub);
+
+        next = first->next.load(memory_order_acquire);
+        if(next != nullptr) {
+            tail = next;
+            return first;
+        }
+        return nullptr;
+    }
+
+    // Take the oldest message, waiting for one
+    T* wait() {
+        while(true) {
+            if(T* message = pop()) return message;
+
+            unique_lock<mutex> lock(sleepMutex);
+            sleeping.store(true, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+
+            T* message = pop();
+            if(message == nullptr) {
+                wake.wait(lock);
+            }
+            sleeping.store(false, memory_order_relaxed);
+            if(message != nullptr) return message;
+        }
+    }
+};
+
+#endif
@@ -2,12 +2,11 @@
 #define MESSAGE_HPP
 
 #include <cstdint>
-#include <mpi.h>
 
 using namespace std;
 
 namespace Tag {
-    // Order sent from the Customer to the Hunter
+    // Batch of orders sent from the Customer to the Hunter
     const int Order = 100;
     // Completed order sent from the Hunter to the Customer
     const int OrderCompletion = 101;
@@ -19,137 +18,329 @@ namespace Tag {
     const int StoreRequest = 104;
 
     const int StoreRequestAck = 105;
-}
 
+    // The Customer will not place any more orders
+    const int Finish = 106;
+    // Termination detection token passed around the ring of Hunters
+    const int Token = 107;
+    // Termination detected - sent to all the Hunters
+    const int Terminate = 108;
+
+    // Request for a store token sent to the token manager
+    const int StoreTokenRequest = 109;
+    // Tells the last holder of a store token where to pass it next
+    const int StoreTokenForward = 110;
+    // Store token passed between the Hunters
+    const int StoreToken = 111;
+
+    // Quorum store admission (Maekawa) - request sent to the quorum
+    const int QuorumRequest = 112;
+    // The arbiter is locked for the request
+    const int QuorumLocked = 113;
+    // The arbiter is locked for a request with a higher priority
+    const int QuorumFailed = 114;
+    // The arbiter asks for its lock back
+    const int QuorumInquire = 115;
+    // The requester gives the lock back to the arbiter
+    const int QuorumRelinquish = 116;
+    // The requester has left the store
+    const int QuorumRelease = 117;
+
+    // Request for one of the pending orders of their owner
+    const int OrderSteal = 118;
+    // Stolen order (if any) sent back by the owner
+    const int OrderStealReply = 119;
+
+    // Range of the tags (used to index per-tag counters)
+    const int First = Order;
+    const int Last = OrderStealReply;
+    const int Count = Last - First + 1;
+
+    inline const char* name(int tag) {
+        switch(tag) {
+        case Order:             return "Order";
+        case OrderCompletion:   return "OrderCompletion";
+        case OrderRequest:      return "OrderRequest";
+        case OrderRequestAck:   return "OrderRequestAck";
+        case StoreRequest:      return "StoreRequest";
+        case StoreRequestAck:   return "StoreRequestAck";
+        case Finish:            return "Finish";
+        case Token:             return "Token";
+        case Terminate:         return "Terminate";
+        case StoreTokenRequest: return "StoreTokenRequest";
+        case StoreTokenForward: return "StoreTokenForward";
+        case StoreToken:        return "StoreToken";
+        case QuorumRequest:     return "QuorumRequest";
+        case QuorumLocked:      return "QuorumLocked";
+        case QuorumFailed:      return "QuorumFailed";
+        case QuorumInquire:     return "QuorumInquire";
+        case QuorumRelinquish:  return "QuorumRelinquish";
+        case QuorumRelease:     return "QuorumRelease";
+        case OrderSteal:        return "OrderSteal";
+        case OrderStealReply:   return "OrderStealReply";
+        default:                return "Unknown";
+        }
+    }
+}
 
+// The messages list their fields in `wire`, encoded as in Wire.hpp
 
 struct Order {
     int64_t customer;
     uint64_t lamport;
+    uint64_t time;
 
-    Order() : customer(0), lamport(0) {}
+    Order() : customer(0), lamport(0), time(0) {}
 
-    Order(int64_t customer, uint64_t lamport) {
+    Order(int64_t customer, uint64_t lamport, uint64_t time = 0) {
         this->customer = customer;
         this->lamport = lamport;
+        this->time = time;
     }
 
     bool operator==(const Order& other) const {
         return customer == other.customer && lamport == other.lamport;
     }
+};
 
-    static MPI_Datatype datatype() {
-        MPI_Datatype orderType;
-        int lengths[2] = {1, 1};
-        MPI_Datatype types[2] = { MPI_INT64_T, MPI_UINT64_T };
-
-        MPI_Aint offsets[2];
-        offsets[0] = offsetof(Order, customer);
-        offsets[1] = offsetof(Order, lamport);
+// New orders of a Customer sent in one message
+struct OrderBatch {
+    static const int MaxOrders = 8;
 
-        MPI_Type_create_struct(2, lengths, offsets, types, &orderType);
-        MPI_Type_commit(&orderType);
+    int64_t customer;
+    uint64_t count;
+    uint64_t orderLamports[MaxOrders];
+    uint64_t orderTimes[MaxOrders];
+    uint64_t lamport;
+    uint64_t time;
 
-        return orderType;
+    // Return the order with the given index
+    Order order(uint64_t index) const {
+        return Order(customer, orderLamports[index], orderTimes[index]);
     }
 
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.value(customer);
+        wire.value(count);
+        if(count > MaxOrders) count = MaxOrders;
+        for(uint64_t i = 0; i < count; i++) {
+            wire.relative(orderLamports[i]);
+            wire.value(orderTimes[i]);
+        }
+    }
 };
 
 struct OrderCompletion {
     int64_t customer;
     uint64_t orderLamport;
     uint64_t lamport;
+    uint64_t time;
+
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.value(customer);
+        wire.relative(orderLamport);
+    }
+};
 
-    static MPI_Datatype datatype() {
-        MPI_Datatype orderType;
-        int lengths[3] = {1, 1, 1};
-        MPI_Datatype types[3] = { MPI_INT64_T, MPI_UINT64_T, MPI_UINT64_T };
-
-        MPI_Aint offsets[3];
-        offsets[0] = offsetof(OrderCompletion, customer);
-        offsets[1] = offsetof(OrderCompletion, orderLamport);
-        offsets[2] = offsetof(OrderCompletion, lamport);
+// Orders a Hunter contests for in one round (served in one mission)
+struct OrderRequest {
+    static const int MaxOrders = 8;
 
-        MPI_Type_create_struct(3, lengths, offsets, types, &orderType);
-        MPI_Type_commit(&orderType);
+    uint64_t count;
+    int64_t orderCustomers[MaxOrders];
+    uint64_t orderLamports[MaxOrders];
+    uint64_t lastOrderLamport;
+    // The store is asked for as well (by a store request with the Lamport value of this one)
+    uint64_t store;
+    uint64_t lamport;
+    uint64_t time;
 
-        return orderType;
+    // Return the order with the given index
+    Order order(uint64_t index) const {
+        return Order(orderCustomers[index], orderLamports[index]);
     }
 
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.relative(lastOrderLamport);
+        wire.value(store);
+        wire.value(count);
+        if(count > MaxOrders) count = MaxOrders;
+        for(uint64_t i = 0; i < count; i++) {
+            wire.value(orderCustomers[i]);
+            wire.relative(orderLamports[i]);
+        }
+    }
 };
 
-struct OrderRequest {
+struct OrderRequestAck {
     int64_t orderCustomer;
     uint64_t orderLamport;
-    uint64_t lastOrderLamport;
+    // The store request granted along with the order (0 - none)
+    uint64_t storeRequestLamport;
     uint64_t lamport;
+    uint64_t time;
+
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.value(orderCustomer);
+        wire.relative(orderLamport);
+        wire.relative(storeRequestLamport);
+    }
+};
 
-    static MPI_Datatype datatype() {
-        MPI_Datatype orderType;
-        int lengths[4] = {1, 1, 1, 1};
-        MPI_Datatype types[4] = { MPI_INT64_T, MPI_UINT64_T, MPI_UINT64_T, MPI_UINT64_T };
+struct StoreRequest {
+    uint64_t lamport;
+    uint64_t time;
 
-        MPI_Aint offsets[4];
-        offsets[0] = offsetof(OrderRequest, orderCustomer);
-        offsets[1] = offsetof(OrderRequest, orderLamport);
-        offsets[2] = offsetof(OrderRequest, lastOrderLamport);
-        offsets[3] = offsetof(OrderRequest, lamport);
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+    }
+};
 
-        MPI_Type_create_struct(4, lengths, offsets, types, &orderType);
-        MPI_Type_commit(&orderType);
+struct StoreRequestAck {
+    uint64_t requestLamport;
+    uint64_t lamport;
+    uint64_t time;
 
-        return orderType;
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.relative(requestLamport);
     }
 };
 
-struct OrderRequestAck {
-    int64_t orderCustomer;
-    uint64_t orderLamport;
+struct Finish {
+    uint64_t orders;
     uint64_t lamport;
+    uint64_t time;
 
-    static MPI_Datatype datatype() {
-        MPI_Datatype orderType;
-        int lengths[3] = {1, 1, 1};
-        MPI_Datatype types[3] = { MPI_INT64_T, MPI_UINT64_T, MPI_UINT64_T };
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.value(orders);
+    }
+};
 
-        MPI_Aint offsets[3];
-        offsets[0] = offsetof(OrderRequestAck, orderCustomer);
-        offsets[1] = offsetof(OrderRequestAck, orderLamport);
-        offsets[2] = offsetof(OrderRequestAck, lamport);
+struct Token {
+    int64_t count;
+    uint64_t black;
+    uint64_t lamport;
+    uint64_t time;
+
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.value(count);
+        wire.value(black);
+    }
+};
 
-        MPI_Type_create_struct(3, lengths, offsets, types, &orderType);
-        MPI_Type_commit(&orderType);
+struct Terminate {
+    uint64_t lamport;
+    uint64_t time;
 
-        return orderType;
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
     }
 };
 
-struct StoreRequestAck {
-    uint64_t requestLamport;
+struct StoreTokenRequest {
     uint64_t lamport;
+    uint64_t time;
 
-    static MPI_Datatype datatype() {
-        MPI_Datatype orderType;
-        int lengths[2] = {1, 1};
-        MPI_Datatype types[2] = { MPI_UINT64_T, MPI_UINT64_T };
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+    }
+};
 
-        MPI_Aint offsets[2];
-        offsets[0] = offsetof(StoreRequestAck, requestLamport);
-        offsets[1] = offsetof(StoreRequestAck, lamport);
+struct StoreTokenForward {
+    int64_t token;
+    int64_t hunter;
+    uint64_t lamport;
+    uint64_t time;
+
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.value(token);
+        wire.value(hunter);
+    }
+};
 
-        MPI_Type_create_struct(2, lengths, offsets, types, &orderType);
-        MPI_Type_commit(&orderType);
+struct StoreToken {
+    int64_t token;
+    uint64_t lamport;
+    uint64_t time;
 
-        return orderType;
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.value(token);
     }
 };
 
-struct Datatype {
-    MPI_Datatype order = Order::datatype();
-    MPI_Datatype orderCompletion = OrderCompletion::datatype();
-    MPI_Datatype orderRequest = OrderRequest::datatype();
-    MPI_Datatype orderRequestAck = OrderRequestAck::datatype();
-    MPI_Datatype storeRequestAck = StoreRequestAck::datatype();
+// Message of the quorum store admission (all the `Quorum*` tags)
+struct QuorumMessage {
+    uint64_t requestLamport;
+    uint64_t lamport;
+    uint64_t time;
+
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.relative(requestLamport);
+    }
+};
+
+struct OrderSteal {
+    uint64_t lamport;
+    uint64_t time;
+
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+    }
+};
+
+struct OrderStealReply {
+    int64_t orderCustomer;
+    uint64_t orderLamport;
+    uint64_t stolen;
+    uint64_t lamport;
+    uint64_t time;
+
+    template<typename Wire>
+    void wire(Wire& wire) {
+        wire.lamport(lamport);
+        wire.value(time);
+        wire.value(orderCustomer);
+        wire.relative(orderLamport);
+        wire.value(stolen);
+    }
 };
 
 #endif
\ No newline at end of file
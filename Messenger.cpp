@@ -0,0 +1,138 @@
+#include "Messenger.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+// Number the message which has just arrived
+uint64_t Messenger::arrived(const MPI_Status& status) {
+    uint64_t key = uint64_t(uint32_t(status.MPI_SOURCE)) << 32 | uint32_t(status.MPI_TAG);
+    return arrivals[key]++;
+}
+
+// Hold the message which has just arrived back
+void Messenger::hold(const MPI_Status& status, uint64_t sequence) {
+    Held& message = held.emplace_back();
+    message.status = status;
+    message.sequence = sequence;
+    const char* data = currentMessage(message.size);
+    memcpy(message.data, data, message.size);
+}
+
+// Deliver a held back message
+void Messenger::deliverHeld(deque<Held>::iterator message, MPI_Status& status) {
+    delivered = *message;
+    deliveredHeld = true;
+    held.erase(message);
+    status = delivered.status;
+}
+
+// Deliver the next message of the replayed order (false for a replayed
+// poll which found none, or if the replay has been given up)
+bool Messenger::replay(MPI_Status& status, bool wait) {
+    const DeliveryLog::Delivery expected = deliveryLog->expected();
+    if(expected.source == DeliveryLog::Missed) {
+        if(wait) {
+            deliveryLog->diverged("a message awaited where none was found");
+        } else {
+            deliveryLog->advance();
+        }
+        return false;
+    }
+
+    auto isExpected = [&expected](const MPI_Status& status, uint64_t sequence) {
+        return status.MPI_SOURCE == expected.source && status.MPI_TAG == expected.tag && sequence == expected.sequence;
+    };
+
+    // Held back already
+    for(auto message = held.begin(); message != held.end(); message++) {
+        if(isExpected(message->status, message->sequence)) {
+            deliverHeld(message, status);
+            deliveryLog->advance();
+            return true;
+        }
+    }
+
+    // Wait for it, holding the other messages back - a poll too, as the
+    // recorded one found it
+    auto lastArrival = chrono::steady_clock::now();
+    while(true) {
+        MPI_Status arrivedStatus;
+        if(!pollMessage(arrivedStatus)) {
+            auto waited = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - lastArrival);
+            if(static_cast<uint64_t>(waited.count()) > deliveryLog->getPatience()) {
+                deliveryLog->diverged("the expected message did not arrive");
+                return false;
+            }
+            this_thread::yield();
+            continue;
+        }
+
+        uint64_t sequence = arrived(arrivedStatus);
+        if(isExpected(arrivedStatus, sequence)) {
+            status = arrivedStatus;
+            deliveryLog->advance();
+            return true;
+        }
+
+        hold(arrivedStatus, sequence);
+        if(held.size() > DeliveryLog::MaxHeld) {
+            deliveryLog->diverged("too many messages held back");
+            return false;
+        }
+        lastArrival = chrono::steady_clock::now();
+    }
+}
+
+// Deliver the next message, waiting for one if `wait` is set
+bool Messenger::deliver(MPI_Status& status, bool wait) {
+    deliveredHeld = false;
+
+    if(!deliveryLog) {
+        if(wait) {
+            receiveMessage(status);
+        } else if(!pollMessage(status)) {
+            return false;
+        }
+        deliveredStatus = status;
+        return true;
+    }
+
+    if(deliveryLog->replaying()) {
+        if(replay(status, wait)) {
+            deliveredStatus = status;
+            return true;
+        }
+        // A replayed poll which found none - unless the replay has been given up
+        if(deliveryLog->replaying()) return false;
+    }
+
+    // In the arrival order - the held back messages first
+    uint64_t sequence;
+    if(!held.empty()) {
+        sequence = held.front().sequence;
+        deliverHeld(held.begin(), status);
+    } else if(wait) {
+        receiveMessage(status);
+        sequence = arrived(status);
+    } else if(pollMessage(status)) {
+        sequence = arrived(status);
+    } else {
+        deliveryLog->record({ DeliveryLog::Missed, 0, 0 });
+        return false;
+    }
+
+    deliveryLog->record({ status.MPI_SOURCE, status.MPI_TAG, sequence });
+    deliveredStatus = status;
+    return true;
+}
+
+// Wait for the next message and return its status (source and tag)
+void Messenger::receive(MPI_Status& status) {
+    deliver(status, true);
+}
+
+// Return the status of the next message if one has arrived, without waiting
+bool Messenger::poll(MPI_Status& status) {
+    return deliver(status, false);
+}
@@ -0,0 +1,186 @@
+#ifndef MESSENGER_HPP
+#define MESSENGER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <mpi.h>
+
+#include "DeliveryLog.hpp"
+#include "Message.hpp"
+#include "Tracer.hpp"
+#include "Wire.hpp"
+
+using namespace std;
+
+// Sends and receives the messages of a single agent (a Customer or a Hunter).
+//
+// Messages are encoded compactly (see Wire.hpp) and decoded by `take`.
+// Messages sent directly between two agents arrive in the order they were
+// sent. The source and the tag of a received message are returned as an
+// `MPI_Status` whatever the transport. With a tracer set, every message
+// sent and taken is traced.
+//
+// With a delivery log set, the order the messages are delivered in is
+// recorded - or a recorded order is replayed: the arrived messages are held
+// back until the log names them. A replay whose run takes another course
+// (the expected message does not come, or too many others do) is given up,
+// and the messages are delivered in their arrival order from then on.
+//
+// `receive` may be called by one thread only, `send` by any thread.
+class Messenger {
+public:
+
+    // Size of a message buffer (at least the size of any encoded message)
+    static constexpr int BufferSize = 256;
+
+protected:
+
+    // Start a send of the encoded message
+    virtual void sendBytes(const char* message, size_t size, int destination, int tag) = 0;
+
+    // Send the encoded message to all the Hunters but this agent
+    virtual void broadcastBytes(const char* message, size_t size, int tag) = 0;
+
+    // Start the collective broadcast of the encoded message from the first Hunter
+    virtual void sendCollectiveBytes(const char* message, size_t size, int tag) = 0;
+
+    // Wait for the next message of the transport and return its status
+    virtual void receiveMessage(MPI_Status& status) = 0;
+
+    // Return the status of the next message of the transport if one has arrived, without waiting
+    virtual bool pollMessage(MPI_Status& status) = 0;
+
+    // Encoded message returned by the last `receiveMessage` or `pollMessage`
+    virtual const char* currentMessage(size_t& size) const = 0;
+
+    // Traces the messages (if set)
+    Tracer* tracer = nullptr;
+
+private:
+
+    // A message held back by a replay
+    struct Held {
+        MPI_Status status;
+        uint64_t sequence;
+        size_t size;
+        char data[BufferSize];
+    };
+
+    // Records or replays the delivery order (if set)
+    DeliveryLog* deliveryLog = nullptr;
+
+    // Number of the arrived messages by source and tag
+    unordered_map<uint64_t, uint64_t> arrivals;
+
+    // Messages held back by a replay, in their arrival order
+    deque<Held> held;
+
+    // Status of the delivered message, and the message if it was held back
+    MPI_Status deliveredStatus;
+    Held delivered;
+    bool deliveredHeld = false;
+
+    // Number the message which has just arrived
+    uint64_t arrived(const MPI_Status& status);
+
+    // Hold the message which has just arrived back
+    void hold(const MPI_Status& status, uint64_t sequence);
+
+    // Deliver a held back message
+    void deliverHeld(deque<Held>::iterator message, MPI_Status& status);
+
+    // Deliver the next message of the replayed order (false for a replayed
+    // poll which found none, or if the replay has been given up)
+    bool replay(MPI_Status& status, bool wait);
+
+    // Deliver the next message, waiting for one if `wait` is set
+    bool deliver(MPI_Status& status, bool wait);
+
+protected:
+
+    // Encode the message into the buffer, returning its size
+    template<typename T>
+    static size_t encode(const T& message, char* buffer) {
+        T fields = message;
+        WireWriter writer(buffer);
+        fields.wire(writer);
+        return writer.size();
+    }
+
+public:
+
+    virtual ~Messenger() = default;
+
+    // Trace the messages from now on
+    void setTracer(Tracer* messageTracer) {
+        tracer = messageTracer;
+    }
+
+    // Record or replay the delivery order from now on
+    void setDeliveryLog(DeliveryLog* log) {
+        deliveryLog = log;
+    }
+
+    // Send a message without waiting for its delivery
+    template<typename T>
+    void send(const T& message, int destination, int tag) {
+        char buffer[BufferSize];
+        sendBytes(buffer, encode(message, buffer), destination, tag);
+        if(tracer) tracer->sent(destination, tag, message.lamport);
+    }
+
+    // Send a message to all the Hunters but this agent
+    template<typename T>
+    void broadcast(const T& message, int tag) {
+        char buffer[BufferSize];
+        broadcastBytes(buffer, encode(message, buffer), tag);
+        if(tracer) tracer->broadcast(tag, message.lamport, false);
+    }
+
+    // Expect a single collective broadcast from the first Hunter - delivered
+    // as a message with the given tag
+    virtual void expectCollective(int tag) = 0;
+
+    // Send the collective broadcast to all the Hunters, this one included
+    // (the first Hunter only, once)
+    template<typename T>
+    void sendCollective(const T& message, int tag) {
+        char buffer[BufferSize];
+        sendCollectiveBytes(buffer, encode(message, buffer), tag);
+        if(tracer) tracer->broadcast(tag, message.lamport, true);
+    }
+
+    // Wait for the next message and return its status (source and tag)
+    void receive(MPI_Status& status);
+
+    // Return the status of the next message if one has arrived, without waiting
+    bool poll(MPI_Status& status);
+
+    // Decode the message returned by the last `receive`
+    template<typename T>
+    void take(T& message) const {
+        size_t size = delivered.size;
+        const char* data = deliveredHeld ? delivered.data : currentMessage(size);
+        WireReader reader(data, size);
+        message.wire(reader);
+
+        if(tracer) {
+            tracer->received(deliveredStatus.MPI_SOURCE, deliveredStatus.MPI_TAG, message.lamport, message.time);
+        }
+    }
+};
+
+// Connects the agents with each other
+class Transport {
+public:
+
+    virtual ~Transport() = default;
+
+    // Make the messenger of the agent
+    virtual unique_ptr<Messenger> connect(int64_t id) = 0;
+};
+
+#endif
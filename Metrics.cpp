@@ -0,0 +1,144 @@
+#include "Metrics.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Number of values in a flattened histogram (buckets + total)
+static const int HistogramSize = Histogram::Buckets + 1;
+
+// Number of values in flattened metrics
+static const int MetricsSize =
+    2 * Tag::Count +                        // sent and received messages
+    2 +                                     // contests and lost contests
+    HistogramSize +                         // order latency
+    HunterStateCount * HistogramSize;       // time in the states
+
+void Histogram::record(uint64_t value) {
+    int bucket = 0;
+    for(uint64_t rest = value; rest > 1 && bucket < Buckets - 1; rest >>= 1) {
+        bucket += 1;
+    }
+    counts[bucket].fetch_add(1, memory_order_relaxed);
+    total.fetch_add(value, memory_order_relaxed);
+}
+
+// Flatten a single histogram
+static uint64_t* flattenHistogram(const Histogram& histogram, uint64_t* values) {
+    for(int i = 0; i < Histogram::Buckets; i++) {
+        *values++ = histogram.counts[i].load();
+    }
+    *values++ = histogram.total.load();
+    return values;
+}
+
+void Metrics::flatten(uint64_t* values) const {
+    for(int i = 0; i < Tag::Count; i++) {
+        *values++ = sentMessages[i].load();
+    }
+    for(int i = 0; i < Tag::Count; i++) {
+        *values++ = receivedMessages[i].load();
+    }
+    *values++ = contests.load();
+    *values++ = lostContests.load();
+    values = flattenHistogram(orderLatency, values);
+    for(int i = 0; i < HunterStateCount; i++) {
+        values = flattenHistogram(stateTime[i], values);
+    }
+}
+
+// Return the upper bound of the bucket holding the given quantile
+static uint64_t quantile(const uint64_t* buckets, uint64_t count, double q) {
+    uint64_t threshold = static_cast<uint64_t>(q * count);
+    uint64_t seen = 0;
+    for(int i = 0; i < Histogram::Buckets; i++) {
+        seen += buckets[i];
+        if(seen > threshold) return uint64_t(1) << (i + 1);
+    }
+    return uint64_t(1) << Histogram::Buckets;
+}
+
+// Print a flattened histogram as JSON
+static const uint64_t* printHistogram(ostream& stream, const uint64_t* values) {
+    uint64_t count = 0;
+    int last = 0;
+    for(int i = 0; i < Histogram::Buckets; i++) {
+        count += values[i];
+        if(values[i] != 0) last = i + 1;
+    }
+    uint64_t total = values[Histogram::Buckets];
+
+    stream << "{ \"count\": " << count
+        << ", \"total_us\": " << total
+        << ", \"mean_us\": " << (count ? total / count : 0)
+        << ", \"p50_us\": " << (count ? quantile(values, count, 0.5) : 0)
+        << ", \"p99_us\": " << (count ? quantile(values, count, 0.99) : 0)
+        << ", \"p999_us\": " << (count ? quantile(values, count, 0.999) : 0)
+        << ", \"buckets\": [";
+    for(int i = 0; i < last; i++) {
+        stream << (i ? ", " : "") << values[i];
+    }
+    stream << "] }";
+
+    return values + HistogramSize;
+}
+
+void Metrics::print(ostream& stream, const uint64_t* values, uint64_t elapsed, int ranks, int64_t agents) {
+    const uint64_t* sent = values;
+    const uint64_t* received = values + Tag::Count;
+    values += 2 * Tag::Count;
+
+    stream << "{\n";
+    stream << "  \"ranks\": " << ranks << ",\n";
+    stream << "  \"agents\": " << agents << ",\n";
+    stream << "  \"elapsed_us\": " << elapsed << ",\n";
+
+    stream << "  \"messages\": {\n";
+    for(int i = 0; i < Tag::Count; i++) {
+        stream << "    \"" << Tag::name(Tag::First + i) << "\": { \"sent\": " << sent[i]
+            << ", \"received\": " << received[i] << " }"
+            << (i + 1 < Tag::Count ? "," : "") << "\n";
+    }
+    stream << "  },\n";
+
+    // Share of the contests lost - each one a wasted round of requests
+    double conflictRate = values[0] > 0 ? static_cast<double>(values[1]) / values[0] : 0;
+    stream << "  \"contests\": { \"total\": " << values[0] << ", \"lost\": " << values[1]
+        << ", \"conflictRate\": " << conflictRate << " },\n";
+    values += 2;
+
+    stream << "  \"orderLatency\": ";
+    values = printHistogram(stream, values);
+    stream << ",\n";
+
+    stream << "  \"stateTime\": {\n";
+    for(int i = 0; i < HunterStateCount; i++) {
+        stream << "    \"" << name(static_cast<HunterState>(i)) << "\": ";
+        values = printHistogram(stream, values);
+        stream << (i + 1 < HunterStateCount ? "," : "") << "\n";
+    }
+    stream << "  }\n";
+    stream << "}\n";
+}
+
+void Metrics::report(const string& file, int64_t agents) {
+    int rank, ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+
+    vector<uint64_t> local(MetricsSize), global(MetricsSize);
+    flatten(local.data());
+    MPI_Reduce(local.data(), global.data(), MetricsSize, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    uint64_t localElapsed = elapsed.load(), globalElapsed = 0;
+    MPI_Reduce(&localElapsed, &globalElapsed, 1, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if(rank != 0) return;
+
+    if(file.empty()) {
+        print(cout, global.data(), globalElapsed, ranks, agents);
+    } else {
+        ofstream stream(file);
+        print(stream, global.data(), globalElapsed, ranks, agents);
+    }
+}
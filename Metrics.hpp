@@ -0,0 +1,94 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <mpi.h>
+
+#include "Common.hpp"
+#include "Message.hpp"
+
+using namespace std;
+
+// Histogram with fixed, power-of-two buckets (in microseconds)
+// Bucket 0 holds values in [0, 2), bucket i holds values in [2^i, 2^(i+1))
+struct Histogram {
+
+    static const int Buckets = 48;
+
+    atomic<uint64_t> counts[Buckets] = {};
+    atomic<uint64_t> total { 0 };
+
+    // Add a value to the histogram
+    void record(uint64_t value);
+};
+
+// Counters and histograms of a single process
+class Metrics {
+private:
+
+    // Messages sent and received, per tag
+    atomic<uint64_t> sentMessages[Tag::Count] = {};
+    atomic<uint64_t> receivedMessages[Tag::Count] = {};
+
+    // Order contests of the Hunter
+    atomic<uint64_t> contests { 0 };
+    atomic<uint64_t> lostContests { 0 };
+
+    // Time of the run (in microseconds)
+    atomic<uint64_t> elapsed { 0 };
+
+    // Order end-to-end latency (measured by the Customer)
+    Histogram orderLatency;
+
+    // Time spent in each of the Hunter states
+    Histogram stateTime[HunterStateCount];
+
+    // Flatten all the values into one array (for the reduction)
+    void flatten(uint64_t* values) const;
+
+    // Print the reduced values as JSON
+    static void print(ostream& stream, const uint64_t* values, uint64_t elapsed, int ranks, int64_t agents);
+
+public:
+
+    // Count a sent message
+    void sent(int tag) {
+        sentMessages[tag - Tag::First].fetch_add(1, memory_order_relaxed);
+    }
+
+    // Count a received message
+    void received(int tag) {
+        receivedMessages[tag - Tag::First].fetch_add(1, memory_order_relaxed);
+    }
+
+    // Count an order contest of the Hunter
+    void contest(bool lost) {
+        contests.fetch_add(1, memory_order_relaxed);
+        if(lost) lostContests.fetch_add(1, memory_order_relaxed);
+    }
+
+    // Record the latency of a completed order
+    void orderCompleted(uint64_t latency) {
+        orderLatency.record(latency);
+    }
+
+    // Record the time spent in the given state
+    void stateLeft(HunterState state, uint64_t duration) {
+        stateTime[static_cast<int>(state)].record(duration);
+    }
+
+    // Set the time of the run (the latest of the agents of the process)
+    void finish(uint64_t time) {
+        uint64_t current = elapsed.load();
+        while(current < time && !elapsed.compare_exchange_weak(current, time)) { }
+    }
+
+    // Reduce the metrics of all the processes to the rank 0 and print them there as JSON
+    // (collective over MPI_COMM_WORLD)
+    void report(const string& file, int64_t agents);
+};
+
+#endif
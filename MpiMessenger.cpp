@@ -0,0 +1,266 @@
+#include "MpiMessenger.hpp"
+
+MpiMessenger::MpiMessenger(const Topology& topology) :
+    topology(topology),
+    receiveRequests(ReceiveCount),
+    receiveBuffers(ReceiveCount)
+    {
+        for(int i = 0; i < ReceiveCount; i++) {
+            MPI_Recv_init(
+                receiveBuffers[i].data,
+                sizeof(Buffer),
+                MPI_BYTE,
+                MPI_ANY_SOURCE,
+                WireTag,
+                MPI_COMM_WORLD,
+                &receiveRequests[i]);
+        }
+
+        // Posted in the ring order - the order the messages are matched in
+        MPI_Startall(receiveRequests.size(), receiveRequests.data());
+
+        sender = thread(&MpiMessenger::loopSender, this);
+    }
+
+MpiMessenger::~MpiMessenger() {
+    Outbound* stop = new Outbound();
+    stop->destination = Stop;
+    outbound.push(stop);
+    sender.join();
+
+    MPI_Waitall(sendRequests.size(), sendRequests.data(), MPI_STATUSES_IGNORE);
+    for(Outbound* message: sendMessages) {
+        delete message;
+    }
+
+    for(MPI_Request& request: receiveRequests) {
+        MPI_Cancel(&request);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        MPI_Request_free(&request);
+    }
+
+    // A collective cannot be cancelled
+    MPI_Wait(&collectiveRequest, MPI_STATUS_IGNORE);
+}
+
+// Expect a single collective broadcast from the first Hunter (`MPI_Ibcast`
+// over the Hunter communicator of a whole envelope, which holds the tag)
+void MpiMessenger::expectCollective(int tag) {
+    MPI_Ibcast(collectiveBuffer.data, sizeof(Buffer), MPI_BYTE, 0, topology.hunterComm, &collectiveRequest);
+}
+
+// Free the slots of the completed sends
+void MpiMessenger::reclaimSends() {
+    if(sendRequests.empty()) return;
+
+    vector<int> completed(sendRequests.size());
+    int count = 0;
+    MPI_Testsome(sendRequests.size(), sendRequests.data(), &count, completed.data(), MPI_STATUSES_IGNORE);
+    if(count == MPI_UNDEFINED) return;
+
+    for(int i = 0; i < count; i++) {
+        delete sendMessages[completed[i]];
+        sendMessages[completed[i]] = nullptr;
+        freeSends.push_back(completed[i]);
+    }
+}
+
+// Take a free slot of the sends
+int MpiMessenger::takeSend() {
+    if(freeSends.empty()) {
+        reclaimSends();
+    }
+    if(freeSends.empty()) {
+        // All the sends are in flight - grow the pool
+        freeSends.push_back(sendRequests.size());
+        sendRequests.push_back(MPI_REQUEST_NULL);
+        sendMessages.push_back(nullptr);
+    }
+
+    int slot = freeSends.back();
+    freeSends.pop_back();
+    return slot;
+}
+
+// Loop performed by the sender thread - start the sends of the queued envelopes
+void MpiMessenger::loopSender() {
+    while(true) {
+        Outbound* message = outbound.wait();
+        if(message->destination == Stop) {
+            delete message;
+            return;
+        }
+
+        int slot = takeSend();
+        sendMessages[slot] = message;
+        if(message->destination == Collective) {
+            MPI_Ibcast(message->buffer.data, sizeof(Buffer), MPI_BYTE, 0, topology.hunterComm, &sendRequests[slot]);
+        } else {
+            MPI_Isend(
+                message->buffer.data, message->size, MPI_BYTE,
+                message->destination, WireTag, MPI_COMM_WORLD, &sendRequests[slot]);
+        }
+    }
+}
+
+// Write the envelope header into the buffer, returning its size
+size_t MpiMessenger::header(char* data, int tag, uint8_t flags, int origin) {
+    WireWriter writer(data);
+    writer.varint(Wire::Version);
+    writer.varint(tag - Tag::First);
+    writer.varint(flags);
+    if(flags & Relayed) {
+        writer.value(origin);
+    }
+    return writer.size();
+}
+
+// Queue a message in an envelope
+void MpiMessenger::sendEnvelope(const char* message, size_t size, int tag, uint8_t flags, int origin, int destination) {
+    Outbound* envelope = new Outbound();
+    size_t offset = header(envelope->buffer.data, tag, flags, origin);
+    memcpy(envelope->buffer.data + offset, message, size);
+    envelope->destination = destination;
+    envelope->size = offset + size;
+    outbound.push(envelope);
+}
+
+// Start a send of the encoded message
+void MpiMessenger::sendBytes(const char* message, size_t size, int destination, int tag) {
+    sendEnvelope(message, size, tag, 0, 0, destination);
+}
+
+// Send the encoded message to all the Hunters but this process
+void MpiMessenger::broadcastBytes(const char* message, size_t size, int tag) {
+    int self = topology.self();
+    int ownNode = topology.node(self);
+
+    for(int node = 0; node < topology.nodeCount(); node++) {
+        const vector<int>& hunters = topology.hunters(node);
+        if(hunters.empty()) continue;
+
+        if(node == ownNode) {
+            for(int hunter: hunters) {
+                if(hunter != self) {
+                    sendBytes(message, size, hunter, tag);
+                }
+            }
+        } else {
+            // A single message to another node - its leader passes it on
+            sendEnvelope(message, size, tag, Relayed | Forward, self, hunters.front());
+        }
+    }
+}
+
+// Start the collective broadcast of the encoded message from the root of the Hunters
+void MpiMessenger::sendCollectiveBytes(const char* message, size_t size, int tag) {
+    // A whole zeroed buffer - the receivers expect the size of a buffer
+    Outbound* envelope = new Outbound();
+    memset(envelope->buffer.data, 0, sizeof(Buffer));
+    size_t offset = header(envelope->buffer.data, tag, 0, 0);
+    memcpy(envelope->buffer.data + offset, message, size);
+    envelope->destination = Collective;
+    envelope->size = sizeof(Buffer);
+    outbound.push(envelope);
+
+    // The root gets its own copy as a regular message
+    sendBytes(message, size, topology.self(), tag);
+}
+
+// Open a received envelope, passing a relayed message on to the rest of the node first if needed
+void MpiMessenger::unwrap(const Buffer& buffer, size_t size, int source) {
+    WireReader reader(buffer.data, size);
+
+    // An envelope of another version cannot be read
+    if(reader.varint() != Wire::Version) return;
+
+    int tag = Tag::First + static_cast<int>(reader.varint());
+    uint8_t flags = static_cast<uint8_t>(reader.varint());
+    if(flags & Relayed) {
+        reader.value(source);
+    }
+    size_t offset = reader.size();
+    if(offset > size) return;
+
+    if(flags & Forward) {
+        int self = topology.self();
+        for(int hunter: topology.hunters(topology.node(self))) {
+            if(hunter != self && hunter != source) {
+                sendEnvelope(buffer.data + offset, size - offset, tag, Relayed, source, hunter);
+            }
+        }
+    }
+
+    Received received;
+    received.status.MPI_SOURCE = source;
+    received.status.MPI_TAG = tag;
+    received.status.MPI_ERROR = MPI_SUCCESS;
+    received.offset = offset;
+    received.size = size - offset;
+    memcpy(received.buffer.data, buffer.data, size);
+    ready.push_back(received);
+}
+
+// Complete the receives of the arrived messages, waiting for one if `wait` is set
+// (returns whether a message is ready)
+bool MpiMessenger::progress(bool wait) {
+    while(ready.empty()) {
+        // Only the next receive of the ring can complete first (or the collective)
+        MPI_Request pending[2] = { receiveRequests[nextReceive], collectiveRequest };
+        MPI_Status status;
+        int index = MPI_UNDEFINED;
+        if(wait) {
+            MPI_Waitany(2, pending, &index, &status);
+        } else {
+            int flag = 0;
+            MPI_Testany(2, pending, &index, &flag, &status);
+            if(!flag) return false;
+        }
+        collectiveRequest = pending[1];
+
+        if(index == 1) {
+            // Completed once - comes from the first Hunter
+            unwrap(collectiveBuffer, sizeof(Buffer), topology.firstHunter());
+            continue;
+        }
+
+        int size = 0;
+        MPI_Get_count(&status, MPI_BYTE, &size);
+        unwrap(receiveBuffers[nextReceive], size, status.MPI_SOURCE);
+
+        // Post the receive again, behind the others
+        MPI_Start(&receiveRequests[nextReceive]);
+        nextReceive = (nextReceive + 1) % receiveRequests.size();
+    }
+    return true;
+}
+
+// Make the next ready message the current one
+void MpiMessenger::next(MPI_Status& status) {
+    current = ready.front();
+    ready.pop_front();
+    status = current.status;
+}
+
+// Wait for the next message and return its status (source and tag)
+void MpiMessenger::receiveMessage(MPI_Status& status) {
+    while(!progress(true)) { }
+    next(status);
+}
+
+// Return the status of the next message if one has arrived, without waiting
+bool MpiMessenger::pollMessage(MPI_Status& status) {
+    if(!progress(false)) return false;
+    next(status);
+    return true;
+}
+
+// Encoded message returned by the last `receiveMessage` or `pollMessage`
+const char* MpiMessenger::currentMessage(size_t& size) const {
+    size = current.size;
+    return current.buffer.data + current.offset;
+}
+
+unique_ptr<Messenger> MpiTransport::connect(int64_t id) {
+    return make_unique<MpiMessenger>(topology);
+}
@@ -0,0 +1,174 @@
+#ifndef MPI_MESSENGER_HPP
+#define MPI_MESSENGER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <mpi.h>
+
+#include "Mailbox.hpp"
+#include "Message.hpp"
+#include "Messenger.hpp"
+#include "Topology.hpp"
+
+using namespace std;
+
+// Messenger over MPI - the non-blocking progress engine of a single process.
+//
+// Every message travels as bytes with a single MPI tag, in an envelope
+// holding the version of the encoding, the message tag and the relay
+// flags (see Wire.hpp for the body). A ring of persistent receives of
+// `MPI_BYTE` is posted and each is restarted as soon as it completes, so
+// messages never wait for a matching receive. The receives are completed
+// in the order they were posted - the order the messages were matched in -
+// so messages from one sender are delivered in the order they were sent,
+// whatever their tags. Sending a message only queues it (a lock-free
+// mailbox, see Mailbox.hpp); a sender thread starts the sends in the queue
+// order with `MPI_Isend` and frees them once they complete, so a sending
+// thread never blocks on MPI or on its peer.
+//
+// `broadcast` sends a message to all the Hunters in two levels: directly
+// to the Hunters on the same node, and once per other node - to its leader,
+// which relays the message to the rest of its node. Relayed messages are
+// delivered as if they came from the original sender.
+//
+// Sending from a thread other than the receiving one requires `MPI_THREAD_MULTIPLE`.
+class MpiMessenger : public Messenger {
+public:
+
+    // MPI tag of all the messages
+    static constexpr int WireTag = 200;
+
+    // Number of the receives posted at once
+    static constexpr int ReceiveCount = 64;
+
+private:
+
+    // Flags of an envelope
+    enum Flags : uint8_t {
+        // Sent on behalf of another Hunter (its identifier follows the flags)
+        Relayed = 1,
+        // The receiving leader passes the message on to the rest of its node
+        Forward = 2,
+    };
+
+    // Envelope header - version, tag and flags, then the origin of a relayed message
+    static constexpr int HeaderSize = 3 + Wire::MaxVarint;
+
+    // Message buffer (room for an envelope)
+    struct Buffer {
+        char data[HeaderSize + BufferSize];
+    };
+
+    // Queued envelope - sent to the destination, or broadcast collectively
+    // (`Collective`), or stopping the sender thread (`Stop`)
+    struct Outbound {
+        atomic<Outbound*> next { nullptr };
+        int destination = 0;
+        size_t size = 0;
+        Buffer buffer;
+    };
+
+    // Destinations of the special envelopes
+    static constexpr int Collective = -1;
+    static constexpr int Stop = -2;
+
+    // Received message
+    struct Received {
+        MPI_Status status;
+        size_t offset;
+        size_t size;
+        Buffer buffer;
+    };
+
+    // Placement of the processes
+    const Topology& topology;
+
+    // Ring of the persistent receives and their buffers, the next one to complete
+    vector<MPI_Request> receiveRequests;
+    deque<Buffer> receiveBuffers;
+    size_t nextReceive = 0;
+
+    // Receive of the collective broadcast (if posted)
+    MPI_Request collectiveRequest = MPI_REQUEST_NULL;
+    Buffer collectiveBuffer;
+
+    // Completed receives not handled yet
+    deque<Received> ready;
+
+    // The message being handled
+    Received current;
+
+    // Envelopes waiting for the sender thread
+    Mailbox<Outbound> outbound;
+
+    // Sends in flight - requests, their envelopes and the free slots (the sender thread only)
+    vector<MPI_Request> sendRequests;
+    vector<Outbound*> sendMessages;
+    vector<int> freeSends;
+
+    thread sender;
+
+    // Free the slots of the completed sends
+    void reclaimSends();
+
+    // Take a free slot of the sends
+    int takeSend();
+
+    // Loop performed by the sender thread - start the sends of the queued envelopes
+    void loopSender();
+
+    // Write the envelope header into the buffer, returning its size
+    static size_t header(char* data, int tag, uint8_t flags, int origin);
+
+    // Queue a message in an envelope
+    void sendEnvelope(const char* message, size_t size, int tag, uint8_t flags, int origin, int destination);
+
+    // Complete the receives of the arrived messages, waiting for one if `wait` is set
+    // (returns whether a message is ready)
+    bool progress(bool wait);
+
+    // Open a received envelope, passing a relayed message on to the rest of the node first if needed
+    void unwrap(const Buffer& buffer, size_t size, int source);
+
+    // Make the next ready message the current one
+    void next(MPI_Status& status);
+
+protected:
+
+    void sendBytes(const char* message, size_t size, int destination, int tag) override;
+    void broadcastBytes(const char* message, size_t size, int tag) override;
+    void sendCollectiveBytes(const char* message, size_t size, int tag) override;
+    void receiveMessage(MPI_Status& status) override;
+    bool pollMessage(MPI_Status& status) override;
+    const char* currentMessage(size_t& size) const override;
+
+public:
+
+    // Post the receives and start the sender thread
+    MpiMessenger(const Topology& topology);
+
+    // Complete the queued sends and cancel the receives
+    ~MpiMessenger();
+
+    void expectCollective(int tag) override;
+};
+
+// Transport over MPI - every agent is a process (its rank is its identifier)
+class MpiTransport : public Transport {
+private:
+
+    // Placement of the processes
+    const Topology& topology;
+
+public:
+
+    MpiTransport(const Topology& topology) :
+        topology(topology)
+        { }
+
+    unique_ptr<Messenger> connect(int64_t id) override;
+};
+
+#endif
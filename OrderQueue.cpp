@@ -0,0 +1,228 @@
+#include "OrderQueue.hpp"
+
+#include <algorithm>
+
+OrderQueue::OrderQueue(size_t customers) :
+    slots(64),
+    watermarks(customers, 0)
+    { }
+
+// Hash of the order key (the splitmix64 finalizer)
+static uint64_t hashOrder(const Order& order) {
+    uint64_t value = static_cast<uint64_t>(order.customer) * 0x9e3779b97f4a7c15ULL + order.lamport;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// Return the slot of the order, or the empty slot where it belongs
+size_t OrderQueue::find(const Order& order) const {
+    size_t mask = slots.size() - 1;
+    size_t index = hashOrder(order) & mask;
+    while(slots[index].state != SlotState::Empty && !(slots[index].order == order)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+// Empty the slot, moving back the following ones (no deleted markers)
+void OrderQueue::clear(size_t index) {
+    size_t mask = slots.size() - 1;
+    used -= 1;
+
+    size_t hole = index;
+    size_t next = (hole + 1) & mask;
+    while(slots[next].state != SlotState::Empty) {
+        size_t home = hashOrder(slots[next].order) & mask;
+        // Move the slot into the hole unless its home lies between them
+        if(((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots[hole] = Slot();
+}
+
+// Insert an order into the table (requires a free slot)
+OrderQueue::Slot& OrderQueue::insert(const Order& order, SlotState state) {
+    reserve();
+    Slot& slot = slots[find(order)];
+    slot.state = state;
+    slot.order = order;
+    used += 1;
+    return slot;
+}
+
+// Grow the table if it is half full
+void OrderQueue::reserve() {
+    if(2 * (used + 1) <= slots.size()) return;
+
+    vector<Slot> previous(slots.size() * 2);
+    swap(previous, slots);
+    for(const Slot& slot: previous) {
+        if(slot.state != SlotState::Empty) {
+            slots[find(slot.order)] = slot;
+        }
+    }
+}
+
+// Check if the FIFO entry is a pending order
+bool OrderQueue::live(const Entry& entry) const {
+    const Slot& slot = slots[find(entry.order)];
+    return slot.state == SlotState::Pending && slot.position == entry.position;
+}
+
+// Drop the entries of the removed orders from the front of the FIFO,
+// and from all of it once they outnumber the pending orders
+void OrderQueue::compact() {
+    while(!fifo.empty() && !live(fifo.front())) {
+        fifo.pop_front();
+    }
+    if(fifo.size() - pending > pending) {
+        fifo.erase(remove_if(fifo.begin(), fifo.end(), [this](const Entry& entry) {
+            return !live(entry);
+        }), fifo.end());
+    }
+    if(fifo.empty()) {
+        frontPosition = backPosition = 0;
+    } else {
+        frontPosition = fifo.front().position;
+    }
+}
+
+// Remove the tombstones below the watermarks
+void OrderQueue::collect() {
+    for(size_t index = 0; index < slots.size(); ) {
+        const Slot& slot = slots[index];
+        if(
+            slot.state == SlotState::Rejected &&
+            slot.order.lamport <= watermarks[slot.order.customer]) {
+            rejected -= 1;
+            clear(index);
+            // Another slot may have moved here
+        } else {
+            index += 1;
+        }
+    }
+    collectAt = max<size_t>(64, 2 * rejected);
+}
+
+// The pending order after the given number of older ones, if any
+// (O(1) for the next index after the last one asked for)
+const Order* OrderQueue::at(size_t index) const {
+    if(index >= pending) return nullptr;
+
+    size_t entry = 0;
+    size_t skip = index;
+    if(cursorValid && cursorIndex <= index) {
+        entry = cursorEntry;
+        skip = index - cursorIndex;
+    }
+
+    for(; entry < fifo.size(); entry++) {
+        if(!live(fifo[entry])) continue;
+        if(skip == 0) {
+            cursorValid = true;
+            cursorIndex = index;
+            cursorEntry = entry;
+            return &fifo[entry].order;
+        }
+        skip -= 1;
+    }
+    return nullptr;
+}
+
+void OrderQueue::push_back(const Order& order) {
+    if(contains(order)) return;
+    size_t index = find(order);
+    if(slots[index].state == SlotState::Rejected) {
+        slots[index].state = SlotState::Pending;
+        rejected -= 1;
+    } else {
+        insert(order, SlotState::Pending);
+        index = find(order);
+    }
+    if(fifo.empty()) {
+        frontPosition = backPosition = 0;
+    }
+    slots[index].position = backPosition;
+    fifo.push_back({ order, backPosition++ });
+    pending += 1;
+}
+
+void OrderQueue::push_front(const Order& order) {
+    if(contains(order)) return;
+    size_t index = find(order);
+    if(slots[index].state == SlotState::Rejected) {
+        slots[index].state = SlotState::Pending;
+        rejected -= 1;
+    } else {
+        insert(order, SlotState::Pending);
+        index = find(order);
+    }
+    if(fifo.empty()) {
+        frontPosition = backPosition = 0;
+        backPosition += 1;
+    } else {
+        frontPosition -= 1;
+    }
+    slots[index].position = frontPosition;
+    fifo.push_front({ order, frontPosition });
+    pending += 1;
+    cursorValid = false;
+}
+
+void OrderQueue::pop_front() {
+    erase(front());
+}
+
+// Check if the order is pending
+bool OrderQueue::contains(const Order& order) const {
+    return slots[find(order)].state == SlotState::Pending;
+}
+
+// Remove a pending order, return whether it was pending
+bool OrderQueue::erase(const Order& order) {
+    size_t index = find(order);
+    if(slots[index].state != SlotState::Pending) return false;
+
+    clear(index);
+    pending -= 1;
+    cursorValid = false;
+    compact();
+    return true;
+}
+
+// An order received from its Customer - add it, unless it has been
+// rejected before (returns whether it was added)
+bool OrderQueue::receive(const Order& order) {
+    uint64_t& watermark = watermarks[order.customer];
+    watermark = max(watermark, order.lamport);
+
+    size_t index = find(order);
+    if(slots[index].state == SlotState::Rejected) {
+        rejected -= 1;
+        clear(index);
+        return false;
+    }
+
+    push_back(order);
+    return true;
+}
+
+// The order is taken by another Hunter - remove it or remember it
+void OrderQueue::reject(const Order& order) {
+    if(erase(order)) return;
+
+    // Already received (and served or dropped) - nothing to remember
+    if(order.lamport <= watermarks[order.customer]) return;
+
+    if(slots[find(order)].state == SlotState::Empty) {
+        insert(order, SlotState::Rejected);
+        rejected += 1;
+        if(rejected >= collectAt) {
+            collect();
+        }
+    }
+}
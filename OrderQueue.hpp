@@ -0,0 +1,132 @@
+#ifndef ORDER_QUEUE_HPP
+#define ORDER_QUEUE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "Message.hpp"
+
+using namespace std;
+
+// Pending orders of a Hunter in the order of arrival, indexed by
+// (customer, Lamport) so that finding and removing any order is O(1).
+//
+// The queue also remembers the orders rejected before they arrived (taken
+// by another Hunter), as tombstones dropping the order when it comes.
+// The orders of a Customer arrive in the order of their Lamport values,
+// so an order at or below the last one received from its Customer (the
+// watermark) will never arrive again - its tombstone is not needed and is
+// collected.
+class OrderQueue {
+private:
+
+    enum class SlotState : uint8_t {
+        Empty,
+        Pending,
+        Rejected
+    };
+
+    // Slot of the hash table (open addressing, linear probing)
+    struct Slot {
+        SlotState state = SlotState::Empty;
+        Order order;
+        // Position of a pending order in the FIFO
+        int64_t position = 0;
+    };
+
+    // Entry of the FIFO - live while the slot of the order has the same position
+    struct Entry {
+        Order order;
+        int64_t position;
+    };
+
+    deque<Entry> fifo;
+    int64_t frontPosition = 0;
+    int64_t backPosition = 0;
+
+    // The last pending order found by `at` (its index and its FIFO entry) -
+    // the next one is looked for from there, so going through the queue in
+    // order is linear. Reset by the changes moving the older orders.
+    mutable bool cursorValid = false;
+    mutable size_t cursorIndex = 0;
+    mutable size_t cursorEntry = 0;
+
+    vector<Slot> slots;
+    size_t used = 0;
+    size_t pending = 0;
+    size_t rejected = 0;
+
+    // Number of the tombstones which triggers the next collection
+    size_t collectAt = 64;
+
+    // Lamport value of the last order received from each Customer
+    vector<uint64_t> watermarks;
+
+    // Return the slot of the order, or the empty slot where it belongs
+    size_t find(const Order& order) const;
+
+    // Empty the slot, moving back the following ones (no deleted markers)
+    void clear(size_t index);
+
+    // Insert an order into the table (requires a free slot)
+    Slot& insert(const Order& order, SlotState state);
+
+    // Grow the table if it is half full
+    void reserve();
+
+    // Drop the entries of the removed orders from the front of the FIFO,
+    // and from all of it once they outnumber the pending orders
+    void compact();
+
+    // Remove the tombstones below the watermarks
+    void collect();
+
+    // Check if the FIFO entry is a pending order
+    bool live(const Entry& entry) const;
+
+public:
+
+    OrderQueue(size_t customers);
+
+    bool empty() const {
+        return pending == 0;
+    }
+
+    size_t size() const {
+        return pending;
+    }
+
+    // The oldest pending order (requires a non-empty queue)
+    const Order& front() const {
+        return fifo.front().order;
+    }
+
+    // The pending order after the given number of older ones, if any
+    // (O(1) for the next index after the last one asked for)
+    const Order* at(size_t index) const;
+
+    void push_back(const Order& order);
+    void push_front(const Order& order);
+    void pop_front();
+
+    // Check if the order is pending
+    bool contains(const Order& order) const;
+
+    // Remove a pending order, return whether it was pending
+    bool erase(const Order& order);
+
+    // An order received from its Customer - add it, unless it has been
+    // rejected before (returns whether it was added)
+    bool receive(const Order& order);
+
+    // The order is taken by another Hunter - remove it or remember it
+    void reject(const Order& order);
+
+    // Number of the remembered rejected orders
+    size_t tombstones() const {
+        return rejected;
+    }
+};
+
+#endif
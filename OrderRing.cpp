@@ -0,0 +1,102 @@
+#include "OrderRing.hpp"
+
+#include <chrono>
+#include <thread>
+
+// Number of the slots - twice the most orders the Customers have pending
+static uint64_t ringCapacity(const Config& config) {
+    uint64_t capacity = 64;
+    while(capacity < 2 * static_cast<uint64_t>(config.hunterMin) * config.maxOrders) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+OrderRing::OrderRing(const Config& config, const Topology& topology) :
+    host(config.hunterMin),
+    capacity(ringCapacity(config))
+    {
+        // The ring lives at the first Hunter only
+        bool hosting = topology.self() == host;
+        MPI_Aint bytes = hosting ? (CellCount + capacity * SlotCellCount) * sizeof(uint64_t) : 0;
+        window = topology.allocateWindow(MPI_COMM_WORLD, bytes, &cells);
+        if(hosting) {
+            cells[Head] = cells[Tail] = 0;
+            for(uint64_t ticket = 0; ticket < capacity; ticket++) {
+                cells[slotCell(ticket, Sequence)] = ticket;
+            }
+        }
+
+        // A single passive epoch for the whole run
+        MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+    }
+
+OrderRing::~OrderRing() {
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+}
+
+// Atomically apply the operation to the cell, returning the previous value
+uint64_t OrderRing::fetchAndOp(uint64_t cell, uint64_t value, MPI_Op op) {
+    uint64_t previous;
+    MPI_Fetch_and_op(&value, &previous, MPI_UINT64_T, host, cell, op, window);
+    MPI_Win_flush(host, window);
+    return previous;
+}
+
+// Index of the cell of the ticket's slot
+uint64_t OrderRing::slotCell(uint64_t ticket, SlotCell cell) const {
+    return CellCount + (ticket & (capacity - 1)) * SlotCellCount + cell;
+}
+
+// Wait until the sequence number of the ticket's slot is the given one
+void OrderRing::waitSequence(uint64_t ticket, uint64_t sequence) {
+    while(fetchAndOp(slotCell(ticket, Sequence), 0, MPI_NO_OP) != sequence) {
+        this_thread::yield();
+    }
+}
+
+// Append an order (a Customer)
+void OrderRing::push(const Order& order) {
+    uint64_t ticket = fetchAndOp(Tail, 1, MPI_SUM);
+
+    // The slot is free once the Hunter of the previous round has read it
+    waitSequence(ticket, ticket);
+
+    uint64_t values[3] = { static_cast<uint64_t>(order.customer), order.lamport, order.time };
+    MPI_Put(values, 3, MPI_UINT64_T, host, slotCell(ticket, OrderCustomer), 3, MPI_UINT64_T, window);
+    MPI_Win_flush(host, window);
+
+    // Publish the order after it is written
+    fetchAndOp(slotCell(ticket, Sequence), ticket + 1, MPI_REPLACE);
+}
+
+// Claim the oldest order, if any (a Hunter)
+bool OrderRing::pop(Order& order) {
+    uint64_t ticket = fetchAndOp(Head, 0, MPI_NO_OP);
+    while(true) {
+        head = ticket;
+        if(ticket >= fetchAndOp(Tail, 0, MPI_NO_OP)) return false;
+
+        // Move the head on unless another Hunter has done it first
+        uint64_t next = ticket + 1, previous;
+        MPI_Compare_and_swap(&next, &ticket, &previous, MPI_UINT64_T, host, Head, window);
+        MPI_Win_flush(host, window);
+        if(previous == ticket) break;
+        ticket = previous;
+    }
+    head = ticket + 1;
+
+    // The Customer may still be writing the slot
+    waitSequence(ticket, ticket + 1);
+
+    uint64_t values[3];
+    MPI_Get(values, 3, MPI_UINT64_T, host, slotCell(ticket, OrderCustomer), 3, MPI_UINT64_T, window);
+    MPI_Win_flush(host, window);
+    order = Order(values[0], values[1], values[2]);
+
+    // Free the slot for the next round
+    fetchAndOp(slotCell(ticket, Sequence), ticket + capacity, MPI_REPLACE);
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef ORDER_RING_HPP
+#define ORDER_RING_HPP
+
+#include <cstdint>
+#include <mpi.h>
+
+#include "Config.hpp"
+#include "Message.hpp"
+#include "Topology.hpp"
+
+using namespace std;
+
+// Global queue of the orders - a ring in an MPI window of the first Hunter.
+//
+// A Customer appends an order by drawing a ticket from the tail with
+// `MPI_Fetch_and_op`, writing the slot and then publishing it with its
+// sequence number. A Hunter claims the next order by moving the head with
+// `MPI_Compare_and_swap` (only while it is behind the tail), reads the slot
+// and frees it for the next round of the ring. So every order goes to
+// exactly one Hunter without any messages.
+class OrderRing {
+private:
+
+    // Cells of the window before the slots
+    enum Cell {
+        Head,
+        Tail,
+        CellCount
+    };
+
+    // Cells of a slot - sequence number (the ticket of the order being
+    // written, the ticket + 1 once written) and the order
+    enum SlotCell {
+        Sequence,
+        OrderCustomer,
+        OrderLamport,
+        OrderTime,
+        SlotCellCount
+    };
+
+    // Window with the ring (at the first Hunter) and its memory
+    MPI_Win window = MPI_WIN_NULL;
+    uint64_t* cells = nullptr;
+
+    // Rank of the first Hunter
+    const int host;
+
+    // Number of the slots (a power of two)
+    const uint64_t capacity;
+
+    // Head seen by the last `pop`
+    uint64_t head = 0;
+
+    // Atomically apply the operation to the cell, returning the previous value
+    uint64_t fetchAndOp(uint64_t cell, uint64_t value, MPI_Op op);
+
+    // Index of the cell of the ticket's slot
+    uint64_t slotCell(uint64_t ticket, SlotCell cell) const;
+
+    // Wait until the sequence number of the ticket's slot is the given one
+    void waitSequence(uint64_t ticket, uint64_t sequence);
+
+public:
+
+    // Allocate the window (collective over all the processes)
+    OrderRing(const Config& config, const Topology& topology);
+
+    // Free the window (collective over all the processes)
+    ~OrderRing();
+
+    OrderRing(const OrderRing&) = delete;
+    OrderRing& operator=(const OrderRing&) = delete;
+
+    // Append an order (a Customer)
+    void push(const Order& order);
+
+    // Claim the oldest order, if any (a Hunter)
+    bool pop(Order& order);
+
+    // Number of the orders claimed so far, as seen by the last `pop`
+    uint64_t claimed() const {
+        return head;
+    }
+};
+
+#endif
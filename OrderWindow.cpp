@@ -0,0 +1,49 @@
+#include "OrderWindow.hpp"
+
+#include <algorithm>
+
+OrderWindow::OrderWindow(const Config& config) :
+    maximum(max<double>(config.maxOrders, 1)),
+    fixedTarget(config.latencyTarget * config.timeUnit),
+    threshold(maximum)
+    { }
+
+// Number of the uncompleted orders allowed
+uint64_t OrderWindow::size() const {
+    return static_cast<uint64_t>(window);
+}
+
+// Latency the window aims for (0 until the first completion)
+uint64_t OrderWindow::target() const {
+    if(fixedTarget != 0) return fixedTarget;
+    return static_cast<uint64_t>(2 * lowest);
+}
+
+// Adjust the window to the latency of a completed order
+void OrderWindow::completed(uint64_t orderLamport, uint64_t latency, uint64_t lamport) {
+    if(smoothed == 0) {
+        smoothed = lowest = latency;
+    } else {
+        smoothed += (latency - smoothed) / 8;
+        lowest = min(lowest, smoothed);
+    }
+
+    if(latency > target()) {
+        // Too slow - back off once for the orders placed with the current window
+        if(orderLamport > recovery) {
+            window = max(minimum, window / 2);
+            threshold = window;
+            recovery = lamport;
+        }
+        return;
+    }
+
+    if(window < threshold) {
+        // Double every window
+        window += 1;
+    } else {
+        // One order more every window
+        window += 1 / window;
+    }
+    window = min(window, maximum);
+}
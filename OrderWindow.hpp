@@ -0,0 +1,55 @@
+#ifndef ORDER_WINDOW_HPP
+#define ORDER_WINDOW_HPP
+
+#include <cstdint>
+
+#include "Config.hpp"
+
+using namespace std;
+
+// Number of the uncompleted orders a Customer may keep (the adaptive flow
+// control), sized from the latencies of the completed orders.
+//
+// The window grows while the latencies stay within the target and halves
+// when an order exceeds it (AIMD) - at most once per window, as the orders
+// placed before a decrease saw the larger window. It starts from a single
+// order and doubles every window until the first decrease. The target is
+// `latencyTarget`, or twice the lowest smoothed latency seen (the latency
+// of an idle system, give or take the queueing of a single order).
+class OrderWindow {
+private:
+
+    // Bounds of the window
+    const double minimum = 1;
+    const double maximum;
+
+    // Fixed latency target (0 - derived from the latencies seen)
+    const uint64_t fixedTarget;
+
+    // Size of the window and the size up to which it doubles
+    double window = 1;
+    double threshold;
+
+    // Smoothed latency (1/8 of each new one, as TCP does) and its lowest value
+    double smoothed = 0;
+    double lowest = 0;
+
+    // Lamport value of the Customer at the last decrease (above the orders placed before it)
+    uint64_t recovery = 0;
+
+public:
+
+    OrderWindow(const Config& config);
+
+    // Number of the uncompleted orders allowed
+    uint64_t size() const;
+
+    // Latency the window aims for (0 until the first completion)
+    uint64_t target() const;
+
+    // Adjust the window to the latency of a completed order (`lamport` -
+    // the Lamport value of the Customer, above those of the orders placed so far)
+    void completed(uint64_t orderLamport, uint64_t latency, uint64_t lamport);
+};
+
+#endif
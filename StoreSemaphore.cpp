@@ -0,0 +1,59 @@
+#include "StoreSemaphore.hpp"
+
+StoreSemaphore::StoreSemaphore(const Topology& topology, uint64_t places) :
+    places(places)
+    {
+        MPI_Comm comm = topology.hunterComm;
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+
+        // The cells live at the first Hunter only
+        MPI_Aint bytes = rank == 0 ? CellCount * sizeof(uint64_t) : 0;
+        window = topology.allocateWindow(comm, bytes, &cells);
+        if(rank == 0) {
+            for(int cell = 0; cell < CellCount; cell++) {
+                cells[cell] = 0;
+            }
+        }
+
+        // A single passive epoch for the whole run
+        MPI_Barrier(comm);
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+    }
+
+StoreSemaphore::~StoreSemaphore() {
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+}
+
+// Atomically apply the operation to the cell, returning the previous value
+uint64_t StoreSemaphore::fetchAndOp(Cell cell, uint64_t value, MPI_Op op) {
+    uint64_t previous;
+    MPI_Fetch_and_op(&value, &previous, MPI_UINT64_T, 0, cell, op, window);
+    MPI_Win_flush(0, window);
+    return previous;
+}
+
+// Draw a ticket and check if it is admitted right away
+bool StoreSemaphore::enter() {
+    ticket = fetchAndOp(Tickets, 1, MPI_SUM);
+    return admitted();
+}
+
+// Check if the ticket drawn by `enter` is admitted
+bool StoreSemaphore::admitted() {
+    uint64_t exits = fetchAndOp(Exits, 0, MPI_NO_OP);
+    if(ticket >= exits + places) return false;
+
+    // The exit is published before it is counted
+    exitLamport = fetchAndOp(Lamport, 0, MPI_NO_OP);
+    exitTime = fetchAndOp(Time, 0, MPI_NO_OP);
+    return true;
+}
+
+// Leave the store, publishing the Lamport value and the time of the exit
+void StoreSemaphore::leave(uint64_t lamport, uint64_t time) {
+    fetchAndOp(Lamport, lamport, MPI_MAX);
+    fetchAndOp(Time, time, MPI_MAX);
+    fetchAndOp(Exits, 1, MPI_SUM);
+}
@@ -0,0 +1,71 @@
+#ifndef STORE_SEMAPHORE_HPP
+#define STORE_SEMAPHORE_HPP
+
+#include <cstdint>
+#include <mpi.h>
+
+#include "Topology.hpp"
+
+using namespace std;
+
+// Counting semaphore of the store kept in an MPI window of the first Hunter.
+//
+// A Hunter draws a ticket with `MPI_Fetch_and_op` and enters the store once
+// fewer than `places` Hunters with earlier tickets are still inside - a
+// ticket queue, so the Hunters are admitted in order. Leaving the store
+// counts an exit. The window is in shared memory when all the processes
+// share it, so the atomics are plain memory operations.
+//
+// Released along with the Lamport value and the time of the last exit,
+// which the admitted Hunter merges like those of a received message.
+class StoreSemaphore {
+private:
+
+    // Cells of the window
+    enum Cell {
+        Tickets,
+        Exits,
+        Lamport,
+        Time,
+        CellCount
+    };
+
+    // Window with the cells (at the first Hunter) and its memory
+    MPI_Win window = MPI_WIN_NULL;
+    uint64_t* cells = nullptr;
+
+    // Number of the places in the store
+    const uint64_t places;
+
+    // Ticket of the current visit
+    uint64_t ticket = 0;
+
+    // Atomically apply the operation to the cell, returning the previous value
+    uint64_t fetchAndOp(Cell cell, uint64_t value, MPI_Op op);
+
+public:
+
+    // Lamport value and time of the last exit, read on admission
+    uint64_t exitLamport = 0;
+    uint64_t exitTime = 0;
+
+    // Allocate the window (collective over the Hunters)
+    StoreSemaphore(const Topology& topology, uint64_t places);
+
+    // Free the window (collective over the Hunters)
+    ~StoreSemaphore();
+
+    StoreSemaphore(const StoreSemaphore&) = delete;
+    StoreSemaphore& operator=(const StoreSemaphore&) = delete;
+
+    // Draw a ticket and check if it is admitted right away
+    bool enter();
+
+    // Check if the ticket drawn by `enter` is admitted
+    bool admitted();
+
+    // Leave the store, publishing the Lamport value and the time of the exit
+    void leave(uint64_t lamport, uint64_t time);
+};
+
+#endif
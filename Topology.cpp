@@ -0,0 +1,72 @@
+#include "Topology.hpp"
+
+#include <algorithm>
+
+Topology::Topology(const Config& config) {
+    int size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    first = config.hunterMin;
+    bool hunter = rank >= config.hunterMin && rank <= config.hunterMax;
+    MPI_Comm_split(MPI_COMM_WORLD, hunter ? 0 : MPI_UNDEFINED, rank, &hunterComm);
+
+    // Processes of the same node
+    MPI_Comm nodeComm;
+    if(config.nodeSize > 0) {
+        MPI_Comm_split(MPI_COMM_WORLD, rank / config.nodeSize, rank, &nodeComm);
+    } else {
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+    }
+
+    // One machine if all the processes can share memory
+    MPI_Comm machineComm;
+    int machineSize;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &machineComm);
+    MPI_Comm_size(machineComm, &machineSize);
+    MPI_Comm_free(&machineComm);
+    int local = machineSize == size, all;
+    MPI_Allreduce(&local, &all, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    sharedMemory = all;
+
+    // A node is known by its lowest rank
+    int key;
+    MPI_Allreduce(&rank, &key, 1, MPI_INT, MPI_MIN, nodeComm);
+    MPI_Comm_free(&nodeComm);
+
+    vector<int> keys(size);
+    MPI_Allgather(&key, 1, MPI_INT, keys.data(), 1, MPI_INT, MPI_COMM_WORLD);
+
+    // Number the nodes in the order of their keys
+    vector<int> sorted = keys;
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+
+    nodes.resize(size);
+    nodeHunters.resize(sorted.size());
+    for(int process = 0; process < size; process++) {
+        nodes[process] = lower_bound(sorted.begin(), sorted.end(), keys[process]) - sorted.begin();
+        if(process >= config.hunterMin && process <= config.hunterMax) {
+            nodeHunters[nodes[process]].push_back(process);
+        }
+    }
+}
+
+// Free the communicators (before MPI_Finalize)
+void Topology::release() {
+    if(hunterComm != MPI_COMM_NULL) {
+        MPI_Comm_free(&hunterComm);
+    }
+}
+
+// Allocate a window with the given bytes at this process (collective over
+// the communicator) - in shared memory if all the processes share it
+MPI_Win Topology::allocateWindow(MPI_Comm comm, MPI_Aint bytes, void* base) const {
+    MPI_Win window;
+    if(sharedMemory) {
+        MPI_Win_allocate_shared(bytes, sizeof(uint64_t), MPI_INFO_NULL, comm, base, &window);
+    } else {
+        MPI_Win_allocate(bytes, sizeof(uint64_t), MPI_INFO_NULL, comm, base, &window);
+    }
+    return window;
+}
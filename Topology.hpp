@@ -0,0 +1,78 @@
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <cstdint>
+#include <vector>
+#include <mpi.h>
+
+#include "Config.hpp"
+
+using namespace std;
+
+// Placement of the processes on the nodes, and the communicator of the Hunters.
+//
+// Processes sharing memory (`MPI_Comm_split_type`) form a node - or, with
+// `nodeSize` set, consecutive ranks are grouped into nodes of that size to
+// try out a multi-node placement on a single machine. The Hunter with the
+// lowest rank on a node is its leader.
+class Topology {
+private:
+
+    // World rank of this process
+    int rank = 0;
+
+    // World rank of the first Hunter (the root of the Hunter communicator)
+    int first = 0;
+
+    // Node of every process (index of the node)
+    vector<int> nodes;
+
+    // Hunters of every node, the leader first
+    vector<vector<int>> nodeHunters;
+
+public:
+
+    // Communicator of the Hunters (MPI_COMM_NULL in the Customers)
+    // - ranks in the order of the world ranks
+    MPI_Comm hunterComm = MPI_COMM_NULL;
+
+    // All the processes share memory (are on one machine, whatever `nodeSize`)
+    bool sharedMemory = false;
+
+    // Find the placement (collective over MPI_COMM_WORLD)
+    Topology(const Config& config);
+
+    // Free the communicators (before MPI_Finalize)
+    void release();
+
+    // Allocate a window with the given bytes at this process (collective over
+    // the communicator) - in shared memory if all the processes share it
+    MPI_Win allocateWindow(MPI_Comm comm, MPI_Aint bytes, void* base) const;
+
+    // World rank of this process
+    int self() const {
+        return rank;
+    }
+
+    // World rank of the first Hunter (the root of the Hunter communicator)
+    int firstHunter() const {
+        return first;
+    }
+
+    // Node of the process
+    int node(int process) const {
+        return nodes[process];
+    }
+
+    // Number of the nodes
+    int nodeCount() const {
+        return nodeHunters.size();
+    }
+
+    // Hunters on the node, the leader first
+    const vector<int>& hunters(int node) const {
+        return nodeHunters[node];
+    }
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//
+// Merger of the trace files of the agents
+//
+// Usage: ./tracemerge <traceFile>.0 <traceFile>.1 ... > trace.json
+//
+// Prints the events of all the given traces (see Tracer.hpp) as a single
+// trace in the Trace Event Format, which opens in Perfetto or
+// chrome://tracing. The times are moved so that the trace starts at zero.
+//
+
+// Event of a trace (a JSON object on a line), its time if it has one
+struct Event {
+    string text;
+    bool timed;
+    uint64_t time;
+};
+
+// Position of the time value of the event, if any
+static size_t timePosition(const string& text) {
+    size_t position = text.find("\"ts\": ");
+    return position == string::npos ? position : position + 6;
+}
+
+// Read all the events of a trace
+static bool readTrace(const string& fileName, vector<Event>& events) {
+    ifstream file(fileName);
+    if(!file) {
+        cerr << "Cannot open " << fileName << "\n";
+        return false;
+    }
+
+    string line;
+    while(getline(file, line)) {
+        // The brackets of the list, and the separators of the events
+        if(line.empty() || line == "[" || line == "]") continue;
+        if(line.back() == ',') line.pop_back();
+        if(line.front() != '{' || line.back() != '}') {
+            cerr << fileName << " is not a trace file\n";
+            return false;
+        }
+
+        Event event { line, false, 0 };
+        if(size_t position = timePosition(line); position != string::npos) {
+            event.timed = true;
+            event.time = stoull(line.substr(position));
+        }
+        events.push_back(event);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    vector<Event> events;
+    for(int i = 1; i < argc; i++) {
+        if(!readTrace(argv[i], events)) return 1;
+    }
+
+    uint64_t start = UINT64_MAX;
+    for(const Event& event: events) {
+        if(event.timed) start = min(start, event.time);
+    }
+
+    cout << "{ \"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    for(size_t i = 0; i < events.size(); i++) {
+        const Event& event = events[i];
+        if(event.timed) {
+            size_t position = timePosition(event.text);
+            size_t end = event.text.find_first_not_of("0123456789", position);
+            cout << event.text.substr(0, position) << event.time - start << event.text.substr(end);
+        } else {
+            cout << event.text;
+        }
+        cout << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    cout << "] }\n";
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "Tracer.hpp"
+
+#include <algorithm>
+
+#include "Message.hpp"
+
+Tracer::Tracer(int64_t id, const string& type, const Config& config, const Clock& clock) :
+    id(id),
+    config(config),
+    clock(clock),
+    offset(clock.origin()),
+    file(config.traceFile + "." + to_string(id))
+    {
+        file << "[\n";
+        string name = type + " " + to_string(id);
+        event("\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " + to_string(id) +
+            ", \"args\": { \"name\": \"" + name + "\" }");
+        event("\"name\": \"process_sort_index\", \"ph\": \"M\", \"pid\": " + to_string(id) +
+            ", \"args\": { \"sort_index\": " + to_string(id) + " }");
+        event("\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " + to_string(id) +
+            ", \"tid\": " + to_string(States) + ", \"args\": { \"name\": \"states\" }");
+        event("\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " + to_string(id) +
+            ", \"tid\": " + to_string(Messages) + ", \"args\": { \"name\": \"messages\" }");
+    }
+
+Tracer::~Tracer() {
+    file << "\n]\n";
+}
+
+// Write an event (the members of a JSON object)
+void Tracer::event(const string& members) {
+    lock_guard<mutex> lock(fileMutex);
+    file << (first ? "" : ",\n") << "{ " << members << " }";
+    first = false;
+}
+
+// Mix the bits of the value (SplitMix64)
+static uint64_t mix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+// Identifier of the flow of a message (53 bits - exact as a JSON number)
+uint64_t Tracer::flow(int source, int destination, int tag, uint64_t lamport) {
+    uint64_t value = mix(lamport);
+    value = mix(value ^ static_cast<uint64_t>(source));
+    value = mix(value ^ static_cast<uint64_t>(destination));
+    value = mix(value ^ static_cast<uint64_t>(tag));
+    return value & ((1ull << 53) - 1);
+}
+
+// A span of the agent (times of its clock)
+void Tracer::span(Track track, const char* name, uint64_t start, uint64_t end) {
+    event(
+        "\"name\": \"" + string(name) + "\", \"ph\": \"X\", \"pid\": " + to_string(id) +
+        ", \"tid\": " + to_string(track) + ", \"ts\": " + to_string(start + offset) +
+        ", \"dur\": " + to_string(max<uint64_t>(end - start, 1)));
+}
+
+// Slice of a sent message and the start of its flow
+void Tracer::sentTo(int destination, int tag, uint64_t lamport, uint64_t time) {
+    string common =
+        "\"name\": \"" + string(Tag::name(tag)) + "\", \"cat\": \"message\", \"pid\": " + to_string(id) +
+        ", \"tid\": " + to_string(Messages) + ", \"ts\": " + to_string(time);
+    event(
+        common + ", \"ph\": \"X\", \"dur\": 1, \"args\": { \"to\": " + to_string(destination) +
+        ", \"lamport\": " + to_string(lamport) + " }");
+    event(common + ", \"ph\": \"s\", \"id\": " + to_string(flow(id, destination, tag, lamport)));
+}
+
+// A message sent to another agent
+void Tracer::sent(int destination, int tag, uint64_t lamport) {
+    sentTo(destination, tag, lamport, clock.now() + offset);
+}
+
+// A message sent to all the Hunters (but this agent unless `self` is set)
+void Tracer::broadcast(int tag, uint64_t lamport, bool self) {
+    uint64_t time = clock.now() + offset;
+    for(int64_t hunter = config.hunterMin; hunter <= config.hunterMax; hunter++) {
+        if(hunter != id || self) {
+            sentTo(hunter, tag, lamport, time);
+        }
+    }
+}
+
+// A message received (sent at the given time of the sender)
+void Tracer::received(int source, int tag, uint64_t lamport, uint64_t time) {
+    // A virtual clock catches up with the sender only after the receipt
+    uint64_t now = clock.now() + offset;
+    if(config.virtualTime) {
+        now = max(now, time);
+    }
+
+    string common =
+        "\"name\": \"" + string(Tag::name(tag)) + "\", \"cat\": \"message\", \"pid\": " + to_string(id) +
+        ", \"tid\": " + to_string(Messages) + ", \"ts\": " + to_string(now);
+    event(
+        common + ", \"ph\": \"X\", \"dur\": 1, \"args\": { \"from\": " + to_string(source) +
+        ", \"lamport\": " + to_string(lamport) + " }");
+    event(common + ", \"ph\": \"f\", \"bp\": \"e\", \"id\": " + to_string(flow(source, id, tag, lamport)));
+}
@@ -0,0 +1,74 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "Clock.hpp"
+#include "Config.hpp"
+
+using namespace std;
+
+// Timeline of a single agent in the Trace Event Format (Chrome, Perfetto),
+// written to `<traceFile>.<id>` - one event a line, see TraceMerge.cpp.
+//
+// The agent is a process (its identifier the pid) with two tracks: the
+// spans of its states, and a short slice for every message sent or
+// received. A flow arrow links the slice of a sent message to the slice of
+// its receipt, both naming it by (source, destination, tag, Lamport value).
+// Times are in microseconds - the virtual time, or the steady clock shared
+// by the processes of a machine in the real mode.
+class Tracer {
+public:
+
+    // Tracks of an agent
+    enum Track {
+        States = 0,
+        Messages = 1
+    };
+
+private:
+
+    const int64_t id;
+    const Config& config;
+    const Clock& clock;
+
+    // Added to the time of the clock (see `Clock::origin`)
+    const uint64_t offset;
+
+    ofstream file;
+    bool first = true;
+    mutex fileMutex;
+
+    // Write an event (the members of a JSON object)
+    void event(const string& members);
+
+    // Identifier of the flow of a message
+    static uint64_t flow(int source, int destination, int tag, uint64_t lamport);
+
+    // Slice of a sent message and the start of its flow
+    void sentTo(int destination, int tag, uint64_t lamport, uint64_t time);
+
+public:
+
+    Tracer(int64_t id, const string& type, const Config& config, const Clock& clock);
+
+    // Close the list of the events
+    ~Tracer();
+
+    // A span of the agent (times of its clock)
+    void span(Track track, const char* name, uint64_t start, uint64_t end);
+
+    // A message sent to another agent
+    void sent(int destination, int tag, uint64_t lamport);
+
+    // A message sent to all the Hunters (but this agent unless `self` is set)
+    void broadcast(int tag, uint64_t lamport, bool self);
+
+    // A message received (sent at the given time of the sender)
+    void received(int source, int tag, uint64_t lamport, uint64_t time);
+};
+
+#endif
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "EventLog.hpp"
+
+using namespace std;
+
+//
+// Offline verifier of the event logs
+//
+// Usage: ./verify <eventFile>.0 <eventFile>.1 ...
+//
+// Streams the events of all the given logs (see EventLog.hpp) in the order
+// of their times and checks that:
+// * at most `shopSize` Hunters are in the store at once,
+// * every placed order is served (its completion sent) exactly once and its
+//   Customer receives exactly one completion.
+// It also breaks the latency of the orders down into the waiting for a
+// Hunter, the contest, the wait for the store, the store and the mission.
+//
+// The logs are mapped into memory and read in place, and only the orders
+// in flight are kept, so logs of any size are verified in a small memory.
+// A Hunter enters the store after the messages (or the window) of the one
+// it follows, which record their times earlier - so a correct run never has
+// too many Hunters in the store at one time, in virtual or real time (real
+// time only for the processes of one machine).
+//
+
+// Exit code if the run violates an invariant
+static const int ViolationExit = 2;
+
+// The most violations printed
+static const uint64_t PrintedViolations = 20;
+
+// Event log mapped into memory
+struct MappedLog {
+    string fileName;
+    const EventRecord* records = nullptr;
+    size_t count = 0;
+    size_t next = 0;
+    void* address = nullptr;
+    size_t length = 0;
+};
+
+// Map a log into memory, returning the store size it was recorded with
+static bool mapLog(MappedLog& log, uint32_t& shopSize) {
+    int descriptor = open(log.fileName.c_str(), O_RDONLY);
+    if(descriptor < 0) {
+        cerr << "Cannot open " << log.fileName << "\n";
+        return false;
+    }
+    struct stat status;
+    fstat(descriptor, &status);
+    log.length = status.st_size;
+
+    EventFile::Header header;
+    if(
+        log.length < sizeof(header) ||
+        pread(descriptor, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        memcmp(header.magic, EventFile::Magic, sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(EventRecord)) {
+
+        cerr << log.fileName << " is not an event log\n";
+        close(descriptor);
+        return false;
+    }
+    shopSize = header.shopSize;
+
+    log.address = mmap(nullptr, log.length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if(log.address == MAP_FAILED) {
+        cerr << "Cannot map " << log.fileName << "\n";
+        return false;
+    }
+    madvise(log.address, log.length, MADV_SEQUENTIAL);
+
+    // A record cut short by an interrupted run is ignored
+    log.records = reinterpret_cast<const EventRecord*>(static_cast<const char*>(log.address) + sizeof(header));
+    log.count = (log.length - sizeof(header)) / sizeof(EventRecord);
+    return true;
+}
+
+// Order of the events of one time - the store left before it is entered,
+// an order placed before it is served, and served before it is completed
+static int eventRank(const EventRecord& record) {
+    switch(record.kind) {
+    case EventKind::StoreLeft:      return 0;
+    case EventKind::OrderPlaced:    return 1;
+    case EventKind::OrderServed:    return 2;
+    case EventKind::OrderCompleted: return 3;
+    case EventKind::State:          return 4;
+    }
+    return 5;
+}
+
+// Durations with power-of-two buckets (in microseconds), for the quantiles
+struct Summary {
+    static const int Buckets = 64;
+
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    uint64_t buckets[Buckets] = {};
+
+    void add(uint64_t value) {
+        count += 1;
+        sum += value;
+        max = std::max(max, value);
+        int bucket = value < 2 ? 0 : 63 - __builtin_clzll(value);
+        buckets[bucket] += 1;
+    }
+
+    // Upper bound of the quantile (the end of its bucket)
+    uint64_t quantile(double q) const {
+        uint64_t target = static_cast<uint64_t>(q * count);
+        uint64_t seen = 0;
+        for(int i = 0; i < Buckets; i++) {
+            seen += buckets[i];
+            if(seen > target) return std::min(max, (uint64_t(2) << i) - 1);
+        }
+        return max;
+    }
+};
+
+// Order in flight
+struct Flight {
+    uint64_t placed = 0;
+    uint64_t served = 0;
+};
+
+// Times the Hunter entered its states in the current round
+struct HunterTimes {
+    uint64_t state[HunterStateCount] = {};
+    uint64_t storeLeft = 0;
+    bool inStore = false;
+};
+
+int main(int argc, char** argv) {
+    vector<MappedLog> logs(argc - 1);
+    uint32_t shopSize = 0;
+    for(int i = 1; i < argc; i++) {
+        logs[i - 1].fileName = argv[i];
+        uint32_t logShopSize;
+        if(!mapLog(logs[i - 1], logShopSize)) return 1;
+        shopSize = max(shopSize, logShopSize);
+    }
+
+    uint64_t violations = 0;
+    auto violation = [&violations](const EventRecord& record) -> ostream& {
+        violations += 1;
+        static ostringstream ignored;
+        if(violations > PrintedViolations) {
+            ignored.str("");
+            return ignored;
+        }
+        return cerr << "Violation at " << record.time << " (agent " << record.agent << ", Lamport " << record.lamport << "): ";
+    };
+
+    // The next records of the logs, the earliest on top
+    auto later = [&logs](size_t a, size_t b) {
+        const EventRecord& x = logs[a].records[logs[a].next];
+        const EventRecord& y = logs[b].records[logs[b].next];
+        if(x.time != y.time) return x.time > y.time;
+        if(eventRank(x) != eventRank(y)) return eventRank(x) > eventRank(y);
+        return a > b;
+    };
+    priority_queue<size_t, vector<size_t>, decltype(later)> heads(later);
+    for(size_t i = 0; i < logs.size(); i++) {
+        if(logs[i].count > 0) heads.push(i);
+    }
+
+    // Orders in flight by (Customer, Lamport)
+    map<pair<int32_t, uint64_t>, Flight> flights;
+    unordered_map<int32_t, HunterTimes> hunters;
+    uint64_t records = 0, placed = 0, served = 0, completed = 0;
+    uint32_t inStore = 0, mostInStore = 0;
+    Summary pending, contest, storeWait, store, mission, total;
+
+    while(!heads.empty()) {
+        size_t head = heads.top();
+        heads.pop();
+        const EventRecord& record = logs[head].records[logs[head].next++];
+        if(logs[head].next < logs[head].count) heads.push(head);
+        records += 1;
+
+        switch(record.kind) {
+        case EventKind::State: {
+            HunterTimes& times = hunters[record.agent];
+            if(record.state >= HunterStateCount) {
+                violation(record) << "unknown state " << int(record.state) << "\n";
+                break;
+            }
+            times.state[record.state] = record.time;
+
+            if(static_cast<HunterState>(record.state) == HunterState::InStore) {
+                times.inStore = true;
+                inStore += 1;
+                mostInStore = max(mostInStore, inStore);
+                if(inStore > shopSize) {
+                    violation(record) << inStore << " Hunters in the store of " << shopSize << " places\n";
+                }
+            }
+            break;
+        }
+
+        case EventKind::StoreLeft: {
+            HunterTimes& times = hunters[record.agent];
+            if(!times.inStore) {
+                violation(record) << "left the store without entering it\n";
+                break;
+            }
+            times.inStore = false;
+            times.storeLeft = record.time;
+            inStore -= 1;
+            break;
+        }
+
+        case EventKind::OrderPlaced:
+            placed += 1;
+            if(!flights.emplace(make_pair(record.customer, record.orderLamport), Flight { record.time, 0 }).second) {
+                violation(record) << "order " << record.customer << ":" << record.orderLamport << " placed twice\n";
+            }
+            break;
+
+        case EventKind::OrderServed: {
+            served += 1;
+            auto flight = flights.find(make_pair(record.customer, record.orderLamport));
+            if(flight == flights.end()) {
+                violation(record) << "order " << record.customer << ":" << record.orderLamport
+                    << " served, but not in flight\n";
+                break;
+            }
+            flight->second.served += 1;
+            if(flight->second.served > 1) {
+                violation(record) << "order " << record.customer << ":" << record.orderLamport << " served twice\n";
+                break;
+            }
+
+            // The round of the Hunter which served the order
+            const HunterTimes& times = hunters[record.agent];
+            const uint64_t* state = times.state;
+            auto since = [](uint64_t later, uint64_t earlier) { return later > earlier ? later - earlier : 0; };
+            pending.add(since(state[int(HunterState::GettingOrder)], flight->second.placed));
+            contest.add(since(state[int(HunterState::GettingStore)], state[int(HunterState::GettingOrder)]));
+            storeWait.add(since(state[int(HunterState::InStore)], state[int(HunterState::GettingStore)]));
+            store.add(since(times.storeLeft, state[int(HunterState::InStore)]));
+            mission.add(since(record.time, state[int(HunterState::Mission)]));
+            break;
+        }
+
+        case EventKind::OrderCompleted: {
+            completed += 1;
+            auto flight = flights.find(make_pair(record.customer, record.orderLamport));
+            if(flight == flights.end()) {
+                violation(record) << "completion of order " << record.customer << ":" << record.orderLamport
+                    << " received, but not in flight\n";
+                break;
+            }
+            if(flight->second.served == 0) {
+                violation(record) << "completion of order " << record.customer << ":" << record.orderLamport
+                    << " received before it was served\n";
+            }
+            total.add(record.time - flight->second.placed);
+            flights.erase(flight);
+            break;
+        }
+        }
+    }
+
+    for(const auto& [order, flight]: flights) {
+        violations += 1;
+        if(violations <= PrintedViolations) {
+            cerr << "Violation: order " << order.first << ":" << order.second
+                << (flight.served ? " served" : " never served") << ", but its completion never received\n";
+        }
+    }
+    if(violations > PrintedViolations) {
+        cerr << "... and " << violations - PrintedViolations << " more\n";
+    }
+
+    for(const MappedLog& log: logs) {
+        munmap(log.address, log.length);
+    }
+
+    cout << "Events: " << records << " in " << logs.size() << " logs\n";
+    cout << "Store: at most " << mostInStore << " Hunters at once, " << shopSize << " places\n";
+    cout << "Orders: " << placed << " placed, " << served << " served, " << completed << " completed\n";
+    cout << "Latency (us)         count        mean         p50         p99         max\n";
+    for(const auto& [title, summary]: initializer_list<pair<const char*, const Summary*>> {
+            { "waiting for Hunter", &pending },
+            { "contest", &contest },
+            { "store queue", &storeWait },
+            { "store", &store },
+            { "mission", &mission },
+            { "total", &total } }) {
+        cout << "  " << left << setw(18) << title << right
+            << setw(8) << summary->count
+            << setw(12) << (summary->count ? summary->sum / summary->count : 0)
+            << setw(12) << summary->quantile(0.5)
+            << setw(12) << summary->quantile(0.99)
+            << setw(12) << summary->max << "\n";
+    }
+    cout << "Violations: " << violations << "\n";
+
+    return violations == 0 ? 0 : ViolationExit;
+}
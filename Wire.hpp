@@ -0,0 +1,139 @@
+#ifndef WIRE_HPP
+#define WIRE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+using namespace std;
+
+// Compact encoding of the message fields.
+//
+// Every field is a varint (LEB128, 7 bits a byte), signed fields are
+// zigzag-encoded first. The Lamport value of a message comes first and
+// the other Lamport values of the message (of the orders, requests...)
+// are sent relative to it, so they mostly take a single byte. Every
+// message lists its fields once, in `wire`, for both the encoding and
+// the decoding:
+//
+//     template<typename Wire>
+//     void wire(Wire& wire) {
+//         wire.lamport(lamport);
+//         wire.value(time);
+//         wire.relative(requestLamport);
+//     }
+namespace Wire {
+
+    // Version of the encoding (the first byte of every envelope)
+    const uint8_t Version = 1;
+
+    // Longest varint
+    const int MaxVarint = 10;
+
+    inline uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+}
+
+// Encodes the fields into a buffer (long enough for any message)
+class WireWriter {
+private:
+
+    char* data;
+    size_t length = 0;
+    uint64_t base = 0;
+
+public:
+
+    WireWriter(char* data) :
+        data(data)
+        { }
+
+    // Number of the bytes written
+    size_t size() const {
+        return length;
+    }
+
+    void varint(uint64_t value) {
+        while(value >= 0x80) {
+            data[length++] = static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        data[length++] = static_cast<char>(value);
+    }
+
+    template<typename T>
+    void value(const T& value) {
+        if constexpr(is_signed_v<T>) {
+            varint(Wire::zigzag(value));
+        } else {
+            varint(value);
+        }
+    }
+
+    // The Lamport value of the message (before any relative one)
+    void lamport(uint64_t value) {
+        base = value;
+        varint(value);
+    }
+
+    // A Lamport value relative to the one of the message
+    void relative(uint64_t value) {
+        varint(Wire::zigzag(static_cast<int64_t>(base - value)));
+    }
+};
+
+// Decodes the fields from a buffer (missing bytes read as zeros)
+class WireReader {
+private:
+
+    const char* data;
+    size_t length;
+    size_t position = 0;
+    uint64_t base = 0;
+
+public:
+
+    WireReader(const char* data, size_t length) :
+        data(data),
+        length(length)
+        { }
+
+    // Number of the bytes read
+    size_t size() const {
+        return position;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for(int shift = 0; position < length && shift < 64; shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(data[position++]);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if((byte & 0x80) == 0) break;
+        }
+        return value;
+    }
+
+    template<typename T>
+    void value(T& value) {
+        if constexpr(is_signed_v<T>) {
+            value = Wire::unzigzag(varint());
+        } else {
+            value = varint();
+        }
+    }
+
+    void lamport(uint64_t& value) {
+        value = base = varint();
+    }
+
+    void relative(uint64_t& value) {
+        value = base - static_cast<uint64_t>(Wire::unzigzag(varint()));
+    }
+};
+
+#endif
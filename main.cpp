@@ -1,29 +1,81 @@
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
 #include <mpi.h>
 
 #include "Config.hpp"
 #include "Customer.hpp"
 #include "Hunter.hpp"
+#include "LocalMessenger.hpp"
+#include "Log.hpp"
+#include "Metrics.hpp"
+#include "MpiMessenger.hpp"
+#include "Topology.hpp"
 
 using namespace std;
 
+// Run the agent with the given identifier
+static void runAgent(int64_t id, const Config& config, Transport& transport, LogSink* logSink, const Topology& topology, Metrics& metrics) {
+    if(id < config.hunterMin) {
+        Customer customer(id, config, transport, logSink, topology, metrics);
+        customer.loop();
+    } else {
+        Hunter hunter(id, config, transport, logSink, topology, metrics);
+        hunter.loop();
+    }
+}
+
 int main(int argc, char** argv) {
-    int tid, threads;
+    int tid, threads, provided;
 
-    MPI_Init(&argc, &argv);
+    // The Hunters send from both of their threads
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    if(provided < MPI_THREAD_MULTIPLE) {
+        cerr << "The MPI library does not support MPI_THREAD_MULTIPLE\n";
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
     MPI_Comm_size(MPI_COMM_WORLD, &threads);
     MPI_Comm_rank(MPI_COMM_WORLD, &tid);
 
     Config config = Config::fromArgs(argc, argv);
+    Metrics metrics;
+    Topology topology(config);
 
-    if(tid < config.hunterMin) {
-        Customer customer(tid, config);
-        customer.loop();
+    // One log for all the agents of the process
+    unique_ptr<LogSink> logSink;
+    if(LOG_LEVEL < LOG_LEVEL_OFF) {
+        logSink = make_unique<LogSink>(config.logFile, tid);
+    }
+
+    if(config.transport == TransportKind::Local) {
+        // All the agents are threads of this process
+        if(threads != 1) {
+            cerr << "transport=local runs all the agents in a single process\n";
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        if(config.storeAdmission == StoreAdmission::Shared || config.orderAssignment == OrderAssignment::Queue) {
+            cerr << "storeAdmission=shared and orderAssignment=queue need transport=mpi\n";
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+
+        LocalTransport transport(config);
+        vector<thread> agents;
+        for(int64_t id = 0; id <= config.hunterMax; id++) {
+            agents.emplace_back(runAgent, id, cref(config), ref(transport), logSink.get(), cref(topology), ref(metrics));
+        }
+        for(thread& agent: agents) {
+            agent.join();
+        }
     } else {
-        Hunter hunter(tid, config);
-        hunter.loop();
+        MpiTransport transport(topology);
+        runAgent(tid, config, transport, logSink.get(), topology, metrics);
     }
-    
+    logSink.reset();
+
+    metrics.report(config.metricsFile, config.hunterMax + 1);
+    topology.release();
+
     MPI_Finalize();
     return 0;
-}
\ No newline at end of file
+}
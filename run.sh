@@ -10,4 +10,5 @@ mpirun --oversubscribe  \
     storeWaitMin=1		\
     storeWaitMax=3		\
     missionWaitMin=1	\
-    missionWaitMax=3     
+    missionWaitMax=3	\
+    "$@"